@@ -27,6 +27,7 @@
 #include "veins/veins.h"
 
 #include "veins/base/phyLayer/Antenna.h"
+#include "veins-vlc/LightDatabase.h"
 
 namespace veins {
 
@@ -44,6 +45,11 @@ public:
     double interModuleDistance;
     std::string radiationPatternId;
     std::string photodiodeId;
+
+    // radiationPatternId and photodiodeId resolved in lightDatabase, if the phy uses one
+    const LightDatabase* lightDatabase = nullptr;
+    int radiationPatternIndex = -1;
+    int photodiodeIndex = -1;
 };
 
 } // namespace veins
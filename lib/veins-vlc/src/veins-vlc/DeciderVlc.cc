@@ -38,8 +38,7 @@
 
 using namespace veins;
 
-#define EV_TRACE \
-    if (debug) EV_LOG(omnetpp::LOGLEVEL_TRACE, nullptr) << "[deciderVlc] "
+#define EV_TRACE VEINS_VLC_TRACE_LOG(debug, "[deciderVlc] ")
 
 using veins::AirFrame;
 
@@ -52,7 +51,7 @@ simtime_t DeciderVlc::processNewSignal(AirFrame* msg)
     Signal& signal = frame->getSignal();
     double recvPower = signal.getAtCenterFrequency();
 
-    signalStates[frame] = EXPECT_END;
+    frame->setSignalState(EXPECT_END);
 
     if (signal.smallerAtCenterFrequency(minPowerLevel)) {
 
@@ -84,13 +83,7 @@ simtime_t DeciderVlc::processNewSignal(AirFrame* msg)
 
 int DeciderVlc::getSignalState(AirFrame* frame)
 {
-
-    if (signalStates.find(frame) == signalStates.end()) {
-        return NEW;
-    }
-    else {
-        return signalStates[frame];
-    }
+    return check_and_cast<AirFrameVlc*>(frame)->getSignalState();
 }
 
 DeciderResult* DeciderVlc::checkIfSignalOk(AirFrame* frame)
@@ -125,7 +118,10 @@ DeciderResult* DeciderVlc::checkIfSignalOk(AirFrame* frame)
 
     DeciderResult80211* result = 0;
 
-    switch (packetOk(sinrMin, snrMin, frame->getBitLength())) {
+    const auto packetResult = packetOk(sinrMin, snrMin, frame->getBitLength());
+    if (traceRing) traceRing->record(TraceRing::Event::DeciderVlcResult, owner->getId(), sinrMin, snrMin, recvPower_dBm, packetResult);
+
+    switch (packetResult) {
 
     case DECODED:
         EV_TRACE << "Packet is fine! We can decode it" << std::endl;
@@ -158,11 +154,17 @@ DeciderResult* DeciderVlc::checkIfSignalOk(AirFrame* frame)
 
 enum DeciderVlc::PACKET_OK_RESULT DeciderVlc::packetOk(double sinrMin, double snrMin, int lengthMPDU)
 {
+    // PDRs of the packet and its header, the ones without interference only for the collision statistics
+    const double snrs[] = {sinrMin, sinrMin, snrMin, snrMin};
+    const int lengths[] = {lengthMPDU, static_cast<int>(PHY_VLC_SHR), lengthMPDU, static_cast<int>(PHY_VLC_SHR)};
+    double pdrs[4];
+    getPdrs(snrs, lengths, pdrs, collectCollisionStats ? 4 : 2);
+
     // compute success rate depending on mcs and packet length
-    double packetOkSinr = getOokPdr(sinrMin, lengthMPDU); // PDR w/o FEC
+    double packetOkSinr = pdrs[0]; // PDR w/o FEC
 
     // check if header is broken
-    double headerOkSinr = getOokPdr(sinrMin, PHY_VLC_SHR);
+    double headerOkSinr = pdrs[1];
 
     double packetOkSnr;
     double headerOkSnr;
@@ -170,9 +172,9 @@ enum DeciderVlc::PACKET_OK_RESULT DeciderVlc::packetOk(double sinrMin, double sn
     // compute PER also for SNR only
     if (collectCollisionStats) {
 
-        packetOkSnr = getOokPdr(snrMin, lengthMPDU);
+        packetOkSnr = pdrs[2];
 
-        headerOkSnr = getOokPdr(snrMin, PHY_VLC_SHR);
+        headerOkSnr = pdrs[3];
 
         // the probability of correct reception without considering the interference
         // MUST be greater or equal than when consider it
@@ -236,13 +238,24 @@ enum DeciderVlc::PACKET_OK_RESULT DeciderVlc::packetOk(double sinrMin, double sn
     }
 }
 
+void DeciderVlc::getPdrs(const double* snrs, const int* lengths, double* pdrs, size_t count) const
+{
+    if (!pdrTable) {
+        getOokPdrs(snrs, lengths, pdrs, count);
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        pdrs[i] = pdrTable->getPdr(snrs[i], lengths[i]);
+    }
+}
+
 simtime_t DeciderVlc::processSignalEnd(AirFrame* msg)
 {
 
     AirFrameVlc* frame = check_and_cast<AirFrameVlc*>(msg);
 
     // remove this frame from our current signals
-    signalStates.erase(frame);
+    frame->setSignalState(NEW);
 
     DeciderResult* result;
 
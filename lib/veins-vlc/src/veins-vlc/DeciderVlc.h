@@ -28,6 +28,8 @@
 #pragma once
 
 #include "veins/base/phyLayer/BaseDecider.h"
+#include "veins-vlc/utility/OokPdrTable.h"
+#include "veins-vlc/utility/Trace.h"
 
 namespace veins {
 
@@ -54,13 +56,14 @@ public:
     };
 
 protected:
-    bool debug = true;
+    bool debug = false;
+    TraceRing* traceRing = nullptr;
+    std::shared_ptr<const OokPdrTable> pdrTable;
     double bitrate;
 
     double myBusyTime;
     double myStartTime;
 
-    std::map<AirFrame*, int> signalStates;
     bool collectCollisionStats;
     unsigned int collisions;
 
@@ -91,6 +94,9 @@ protected:
     /** @brief computes if packet is ok or has errors*/
     enum DeciderVlc::PACKET_OK_RESULT packetOk(double snirMin, double snrMin, int lengthMPDU);
 
+    /** @brief computes the PDRs of count packets, exactly or from the pdrTable*/
+    void getPdrs(const double* snrs, const int* lengths, double* pdrs, size_t count) const;
+
 public:
     /**
      * @brief Initializes the Decider with a pointer to its PhyLayer and
@@ -106,6 +112,24 @@ public:
     }
 
     int getSignalState(AirFrame* frame);
+
+    /** @brief Enables the trace log of every frame, unless compiled away.*/
+    void setDebug(bool enabled)
+    {
+        debug = enabled;
+    }
+
+    /** @brief Records the decision on every frame in ring, nullptr to stop.*/
+    void setTraceRing(TraceRing* ring)
+    {
+        traceRing = ring;
+    }
+
+    /** @brief Looks up packet delivery ratios in table instead of computing them, nullptr to compute them.*/
+    void setPdrTable(std::shared_ptr<const OokPdrTable> table)
+    {
+        pdrTable = std::move(table);
+    }
     virtual ~DeciderVlc();
     /**
      * @brief invoke this method when the phy layer is also finalized,
@@ -0,0 +1,202 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "veins-vlc/LightDatabase.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <omnetpp.h>
+
+using namespace veins;
+using omnetpp::cRuntimeError;
+
+namespace {
+
+const char fileMagic[8] = {'V', 'L', 'C', 'L', 'I', 'G', 'H', 'T'};
+const uint32_t fileVersion = 1;
+
+static_assert(sizeof(LightDatabase::FileHeader) == 32, "layout of FileHeader must match bin/veins_vlc_lightdb");
+static_assert(sizeof(LightDatabase::RadiationPatternEntry) == 112, "layout of RadiationPatternEntry must match bin/veins_vlc_lightdb");
+static_assert(sizeof(LightDatabase::PhotodiodeEntry) == 64, "layout of PhotodiodeEntry must match bin/veins_vlc_lightdb");
+
+// average photo-current produced by the photodiode
+double calcCurrentFactor(const RadiationPattern& radiationPattern, const Photodiode& photodiode)
+{
+    const LightValues& emission = radiationPattern.getSpectralEmission();
+    const LightValues& response = photodiode.getSpectralResponse();
+    if (emission.size() != response.size()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double sumEmission = 0;
+    double sumEmissionResponse = 0;
+    for (size_t i = 0; i < emission.size(); ++i) {
+        sumEmission += emission[i];
+        sumEmissionResponse += emission[i] * response[i];
+    }
+    return sumEmissionResponse / sumEmission;
+}
+
+std::string idOf(const char (&id)[LightDatabase::idLength])
+{
+    return std::string(id, strnlen(id, LightDatabase::idLength));
+}
+
+} // namespace
+
+std::shared_ptr<const LightDatabase> LightDatabase::open(const std::string& fileName)
+{
+    static std::map<std::string, std::weak_ptr<const LightDatabase>> openDatabases;
+
+    auto database = openDatabases[fileName].lock();
+    if (!database) {
+        database = std::make_shared<const LightDatabase>(fileName);
+        openDatabases[fileName] = database;
+    }
+    return database;
+}
+
+LightDatabase::LightDatabase(const std::string& fileName)
+    : fileName(fileName)
+{
+#ifndef _WIN32
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw cRuntimeError("Could not open light database %s: %s (create it with bin/veins_vlc_lightdb)", fileName.c_str(), strerror(errno));
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+        size = fileStat.st_size;
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        data = mapped == MAP_FAILED ? nullptr : static_cast<const char*>(mapped);
+    }
+    ::close(fd);
+    if (!data) {
+        size = 0;
+        throw cRuntimeError("Could not map light database %s", fileName.c_str());
+    }
+#else
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file) {
+        throw cRuntimeError("Could not open light database %s (create it with bin/veins_vlc_lightdb)", fileName.c_str());
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data = buffer.data();
+    size = buffer.size();
+#endif
+
+    try {
+        readEntries();
+    }
+    catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+LightDatabase::~LightDatabase()
+{
+    unmap();
+}
+
+void LightDatabase::unmap()
+{
+#ifndef _WIN32
+    if (data) {
+        munmap(const_cast<char*>(data), size);
+    }
+#endif
+    data = nullptr;
+}
+
+void LightDatabase::readEntries()
+{
+    FileHeader header;
+    if (size < sizeof(header)) {
+        throw cRuntimeError("Light database %s is truncated", fileName.c_str());
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0 || header.version != fileVersion) {
+        throw cRuntimeError("%s is no light database of version %u, create it with bin/veins_vlc_lightdb", fileName.c_str(), fileVersion);
+    }
+    const size_t valuesStart = sizeof(FileHeader) + header.radiationPatternCount * sizeof(RadiationPatternEntry) + header.photodiodeCount * sizeof(PhotodiodeEntry);
+    if (size < valuesStart || (size - valuesStart) / sizeof(double) < header.valueCount) {
+        throw cRuntimeError("Light database %s is truncated", fileName.c_str());
+    }
+
+    const auto* radiationPatternEntries = reinterpret_cast<const RadiationPatternEntry*>(data + sizeof(FileHeader));
+    const auto* photodiodeEntries = reinterpret_cast<const PhotodiodeEntry*>(radiationPatternEntries + header.radiationPatternCount);
+    const char* firstValue = data + valuesStart;
+    for (uint32_t i = 0; i < header.radiationPatternCount; ++i) {
+        const auto& entry = radiationPatternEntries[i];
+        radiationPatternIds.push_back(idOf(entry.id));
+        radiationPatterns.emplace_back(values(entry.patternLeft, firstValue, header.valueCount), values(entry.patternRight, firstValue, header.valueCount), values(entry.anglesLeft, firstValue, header.valueCount), values(entry.anglesRight, firstValue, header.valueCount), values(entry.spectralEmission, firstValue, header.valueCount));
+    }
+    for (uint32_t i = 0; i < header.photodiodeCount; ++i) {
+        const auto& entry = photodiodeEntries[i];
+        photodiodeIds.push_back(idOf(entry.id));
+        photodiodes.emplace_back(entry.area, entry.gain, values(entry.spectralResponse, firstValue, header.valueCount));
+    }
+
+    for (const auto& radiationPattern : radiationPatterns) {
+        for (const auto& photodiode : photodiodes) {
+            photocurrentFactors.push_back(photodiode.getArea() * calcCurrentFactor(radiationPattern, photodiode) * photodiode.getGain());
+        }
+    }
+}
+
+LightValues LightDatabase::values(const ValuesEntry& entry, const char* first, uint64_t valueCount) const
+{
+    if (entry.offset > valueCount || entry.count > valueCount - entry.offset) {
+        throw cRuntimeError("Light database %s references values beyond its end", fileName.c_str());
+    }
+    return {reinterpret_cast<const double*>(first) + entry.offset, entry.count};
+}
+
+int LightDatabase::getRadiationPatternIndex(const std::string& id) const
+{
+    auto it = std::find(radiationPatternIds.begin(), radiationPatternIds.end(), id);
+    if (it == radiationPatternIds.end()) {
+        throw cRuntimeError("No id matching %s found in list of radiation patterns", id.c_str());
+    }
+    return it - radiationPatternIds.begin();
+}
+
+int LightDatabase::getPhotodiodeIndex(const std::string& id) const
+{
+    auto it = std::find(photodiodeIds.begin(), photodiodeIds.end(), id);
+    if (it == photodiodeIds.end()) {
+        throw cRuntimeError("No id matching %s found in list of photodiodes", id.c_str());
+    }
+    return it - photodiodeIds.begin();
+}
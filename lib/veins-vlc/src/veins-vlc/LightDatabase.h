@@ -0,0 +1,133 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "veins-vlc/veins-vlc.h"
+
+#include "veins-vlc/Photodiode.h"
+#include "veins-vlc/RadiationPattern.h"
+
+namespace veins {
+
+/**
+ * @brief Radiation patterns and photodiodes for the LsvLightModel, memory mapped from a binary file.
+ *
+ * The file is created from the text files of radiation patterns and photodiodes by
+ * bin/veins_vlc_lightdb. Its layout (little endian, all offsets in bytes from the start of the file):
+ *
+ *  - FileHeader
+ *  - RadiationPatternEntry[radiationPatternCount]
+ *  - PhotodiodeEntry[photodiodeCount]
+ *  - double[valueCount], referenced by the entries as offset into this array and count
+ *
+ * All modules (and all processes) opening the same file share its pages.
+ * Lights and photodiodes are looked up by id once during initialization, afterwards only by index.
+ */
+class VEINS_VLC_API LightDatabase {
+public:
+    static constexpr size_t idLength = 32; // including the terminating NUL
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t radiationPatternCount;
+        uint32_t photodiodeCount;
+        uint32_t reserved;
+        uint64_t valueCount;
+    };
+    struct ValuesEntry {
+        uint64_t offset;
+        uint64_t count;
+    };
+    struct RadiationPatternEntry {
+        char id[idLength];
+        ValuesEntry patternLeft;
+        ValuesEntry patternRight;
+        ValuesEntry anglesLeft;
+        ValuesEntry anglesRight;
+        ValuesEntry spectralEmission;
+    };
+    struct PhotodiodeEntry {
+        char id[idLength];
+        double area;
+        double gain;
+        ValuesEntry spectralResponse;
+    };
+
+    /**
+     * Returns the database stored in fileName, mapping it if no module has it open yet.
+     */
+    static std::shared_ptr<const LightDatabase> open(const std::string& fileName);
+
+    explicit LightDatabase(const std::string& fileName);
+    LightDatabase(const LightDatabase&) = delete;
+    LightDatabase& operator=(const LightDatabase&) = delete;
+    ~LightDatabase();
+
+    /** @brief Index of the radiation pattern with the given id, throws if there is none.*/
+    int getRadiationPatternIndex(const std::string& id) const;
+    /** @brief Index of the photodiode with the given id, throws if there is none.*/
+    int getPhotodiodeIndex(const std::string& id) const;
+
+    const RadiationPattern& getRadiationPattern(int index) const
+    {
+        return radiationPatterns[index];
+    }
+    const Photodiode& getPhotodiode(int index) const
+    {
+        return photodiodes[index];
+    }
+
+    /**
+     * Photo-current per irradiance of a photodiode facing a light with the given radiation pattern.
+     *
+     * Combines the area and gain of the photodiode with the average of its spectral response,
+     * weighted by the spectral emission of the light. NaN if the spectra do not match.
+     */
+    double getPhotocurrentFactor(int radiationPatternIndex, int photodiodeIndex) const
+    {
+        return photocurrentFactors[radiationPatternIndex * photodiodes.size() + photodiodeIndex];
+    }
+
+private:
+    std::string fileName;
+    const char* data = nullptr;
+    size_t size = 0;
+    std::vector<char> buffer; // holds the file where it cannot be mapped
+
+    std::vector<std::string> radiationPatternIds;
+    std::vector<RadiationPattern> radiationPatterns;
+    std::vector<std::string> photodiodeIds;
+    std::vector<Photodiode> photodiodes;
+    std::vector<double> photocurrentFactors; // by radiation pattern, then photodiode
+
+    void readEntries();
+    void unmap();
+    LightValues values(const ValuesEntry& entry, const char* first, uint64_t valueCount) const;
+};
+
+} // namespace veins
@@ -19,27 +19,18 @@
 //
 
 #include "veins-vlc/Photodiode.h"
-/**
-   Photodiode::Photodiode(std::string m_id, double m_area, double m_gain, std::vector<double> m_spectralResponse) {
-    id = m_id;
-    area = m_area;
-    gain = m_gain;
-    spectralResponse = m_spectralResponse;
-   }
 
-   PhotoDiode::~PhotoDiode(){}
- */
-double Photodiode::getArea()
+double Photodiode::getArea() const
 {
     return area;
 }
 
-double Photodiode::getGain()
+double Photodiode::getGain() const
 {
     return gain;
 }
 
-std::vector<double>& Photodiode::getSpectralResponse()
+const LightValues& Photodiode::getSpectralResponse() const
 {
     return spectralResponse;
 }
@@ -20,26 +20,24 @@
 
 #pragma once
 
-#include <string>
-#include <vector>
+#include "veins-vlc/utility/LightValues.h"
 
+/**
+ * Photodiode of a receiver, its spectral response is owned by the LightDatabase it is stored in.
+ */
 class Photodiode {
 public:
-    Photodiode(std::string m_id, double m_area, double m_gain, std::vector<double> m_spectralResponse)
-        : id(m_id)
-        , area(m_area)
+    Photodiode(double m_area, double m_gain, LightValues m_spectralResponse)
+        : area(m_area)
         , gain(m_gain)
         , spectralResponse(m_spectralResponse){};
 
-    //  ~Photodiode();
-
-    double getArea();
-    double getGain();
-    std::vector<double>& getSpectralResponse();
+    double getArea() const;
+    double getGain() const;
+    const LightValues& getSpectralResponse() const;
 
 private:
-    std::string id;
     double area;
     double gain;
-    std::vector<double> spectralResponse;
+    LightValues spectralResponse;
 };
@@ -38,11 +38,6 @@ using std::unique_ptr;
 
 Define_Module(veins::PhyLayerVlc);
 
-/* Used for the LsvLightModel */
-bool PhyLayerVlc::mapsInitialized = false;
-std::map<std::string, Photodiode> PhyLayerVlc::photodiodeMap = std::map<std::string, Photodiode>();
-std::map<std::string, RadiationPattern> PhyLayerVlc::radiationPatternMap = std::map<std::string, RadiationPattern>();
-
 void PhyLayerVlc::initialize(int stage)
 {
     if (stage == 0) {
@@ -54,8 +49,42 @@ void PhyLayerVlc::initialize(int stage)
 
         // Create frequency mappings and initialize spectrum for signal representation
         overallSpectrum = Spectrum({666e12});
+
+        // needed by the connection manager when BasePhyLayer::initialize registers the nic
+        hostId = getModuleByPath("^.^.")->getId();
+
+        // needed by the analogue models and decider created in BasePhyLayer::initialize
+        debug = par("debug").boolValue();
+        std::string traceFile = par("traceFile").stdstringValue();
+        if (!traceFile.empty()) {
+            traceRing = TraceRing::open(traceFile, par("traceRingSize").intValue());
+        }
     }
     BasePhyLayer::initialize(stage);
+    if (stage == 0 && lightDatabase) {
+        // look up the light data of this nic only once, light models then access it by index
+        auto* antennaVlc = check_and_cast<AntennaVlc*>(antenna.get());
+        antennaVlc->lightDatabase = lightDatabase.get();
+        antennaVlc->radiationPatternIndex = lightDatabase->getRadiationPatternIndex(antennaVlc->radiationPatternId);
+        antennaVlc->photodiodeIndex = lightDatabase->getPhotodiodeIndex(antennaVlc->photodiodeId);
+    }
+}
+
+void PhyLayerVlc::finish()
+{
+    BasePhyLayer::finish();
+
+    // frames the light models dropped before their detailed calculations
+    long framesChecked = 0;
+    long framesRejected = 0;
+    for (const auto& model : analogueModels) {
+        if (auto precheck = dynamic_cast<const GeometryPrecheck*>(model.get())) {
+            framesChecked += precheck->getFramesChecked();
+            framesRejected += precheck->getFramesRejected();
+        }
+    }
+    recordScalar("geometryPrecheckFrames", framesChecked);
+    recordScalar("geometryPrecheckRejected", framesRejected);
 }
 
 unique_ptr<AnalogueModel> PhyLayerVlc::getAnalogueModelFromName(std::string name, ParameterMap& params)
@@ -111,118 +140,34 @@ unique_ptr<AnalogueModel> PhyLayerVlc::initializeEmpiricalLightModel(ParameterMa
         error("`taillightMaxTxAngle` has not been specified in config-vlc.xml");
     }
 
-    return make_unique<EmpiricalLightModel>(this, FWMath::mW2dBm(minPowerLevel), headlightMaxTxRange, taillightMaxTxRange, headlightMaxTxAngle, taillightMaxTxAngle);
+    // optional, defaults to the measurement at the whole metres towards the transmitter
+    bool interpolate = false;
+    it = params.find("interpolate");
+    if (it != params.end()) {
+        interpolate = it->second.boolValue();
+    }
+
+    auto model = make_unique<EmpiricalLightModel>(this, FWMath::mW2dBm(minPowerLevel), headlightMaxTxRange, taillightMaxTxRange, headlightMaxTxAngle, taillightMaxTxAngle, interpolate);
+    model->setDebug(debug);
+    model->setTraceRing(traceRing.get());
+    return model;
 }
 
-// version using line-by-line parsing
+// radiation patterns and photodiodes come from a binary light database, see LightDatabase.h
 unique_ptr<AnalogueModel> PhyLayerVlc::initializeLsvLightModel(ParameterMap& params)
 {
-    if (mapsInitialized == false) {
-
-        ParameterMap::iterator it;
-        std::string radiationPatternFile;
-        std::string photodiodeFile;
-
-        it = params.find("radiationPatternFile");
-        if (it != params.end()) {
-            radiationPatternFile = it->second.stringValue();
-        }
-        else {
-            error("`radiationPatternFile` has not been specified in config-vlc-lsv.xml");
-        }
-
-        it = params.find("photodiodeFile");
-        if (it != params.end()) {
-            photodiodeFile = it->second.stringValue();
-        }
-        else {
-            error("`photodiodeFile` has not been specified in config-vlc-lsv.xml");
-        }
-
-        // For file parsing
-        std::ifstream inputFile(radiationPatternFile);
-        std::string line;
-        int lineCounter;
-        double value;
-
-        // For radiation pattern
-        std::string Id;
-        std::vector<double> patternL, patternR, anglesL, anglesR, spectralEmission;
-
-        lineCounter = 0;
-        while (std::getline(inputFile, line)) {
-            std::istringstream iss(line);
-            switch (lineCounter) {
-            case 0:
-                iss >> Id;
-                ++lineCounter;
-                break;
-            case 1:
-                while (iss >> value) patternL.push_back(value);
-                ++lineCounter;
-                break;
-            case 2:
-                while (iss >> value) patternR.push_back(value);
-                ++lineCounter;
-                break;
-            case 3:
-                while (iss >> value) anglesL.push_back(value);
-                ++lineCounter;
-                break;
-            case 4:
-                while (iss >> value) anglesR.push_back(value);
-                ++lineCounter;
-                break;
-            case 5:
-                while (iss >> value) spectralEmission.push_back(value);
-                lineCounter = 0;
-                radiationPatternMap.insert(std::pair<std::string, RadiationPattern>(Id, RadiationPattern(Id, patternL, patternR, anglesL, anglesR, spectralEmission)));
-                // Clear all vectors for next pattern
-                patternL.clear();
-                patternR.clear();
-                anglesL.clear();
-                anglesR.clear();
-                spectralEmission.clear();
-                break;
-            }
-            iss.str("");
-        }
-
-        // For file parsing
-        std::ifstream inputFile2(photodiodeFile);
-
-        // For photodiode
-        double area, gain;
-        std::vector<double> spectralResponse;
-
-        lineCounter = 0;
-        while (std::getline(inputFile2, line)) {
-            std::istringstream iss(line);
-            switch (lineCounter) {
-            case 0:
-                iss >> Id;
-                ++lineCounter;
-                break;
-            case 1:
-                iss >> area;
-                ++lineCounter;
-                break;
-            case 2:
-                iss >> gain;
-                ++lineCounter;
-                break;
-            case 3:
-                while (iss >> value) spectralResponse.push_back(value);
-                lineCounter = 0;
-                photodiodeMap.insert(std::pair<std::string, Photodiode>(Id, Photodiode(Id, area, gain, spectralResponse)));
-                spectralResponse.clear();
-                break;
-            }
-            iss.str("");
-        }
-        mapsInitialized = true;
+    if (params.count("radiationPatternFile") || params.count("photodiodeFile")) {
+        error("`radiationPatternFile` and `photodiodeFile` have been replaced by `lightDatabaseFile` in config-vlc-lsv.xml, convert them with bin/veins_vlc_lightdb <radiationPatternFile> <photodiodeFile> <lightDatabaseFile> (make lightdb does so for the example)");
+    }
+    ParameterMap::iterator it = params.find("lightDatabaseFile");
+    if (it == params.end()) {
+        error("`lightDatabaseFile` has not been specified in config-vlc-lsv.xml, create it from the radiation pattern and photodiode files with bin/veins_vlc_lightdb");
     }
-    return make_unique<LsvLightModel>(this, &radiationPatternMap, &photodiodeMap, FWMath::mW2dBm(minPowerLevel));
+    lightDatabase = LightDatabase::open(it->second.stringValue());
+    auto model = make_unique<LsvLightModel>(this, lightDatabase, FWMath::mW2dBm(minPowerLevel));
+    model->setDebug(debug);
+    model->setTraceRing(traceRing.get());
+    return model;
 }
 
 unique_ptr<Decider> PhyLayerVlc::getDeciderFromName(std::string name, ParameterMap& params)
@@ -258,6 +203,7 @@ std::shared_ptr<Antenna> PhyLayerVlc::initializeAntennaHeadlight(ParameterMap& p
     std::string radiationPatternId = par("radiationPatternId");
     std::string photodiodeId = par("photodiodeId");
 
+    lightingModuleOrientation = HEAD;
     return std::make_shared<AntennaHeadlight>(photodiodeGroundOffsetZ, interModuleDistance, radiationPatternId, photodiodeId);
 }
 
@@ -268,6 +214,7 @@ std::shared_ptr<Antenna> PhyLayerVlc::initializeAntennaTaillight(ParameterMap& p
     std::string radiationPatternId = par("radiationPatternId");
     std::string photodiodeId = par("photodiodeId");
 
+    lightingModuleOrientation = TAIL;
     return std::make_shared<AntennaTaillight>(photodiodeGroundOffsetZ, interModuleDistance, radiationPatternId, photodiodeId);
 }
 
@@ -285,6 +232,19 @@ unique_ptr<AnalogueModel> PhyLayerVlc::initializeVehicleObstacleShadowingForVlc(
 unique_ptr<Decider> PhyLayerVlc::initializeDeciderVlc(ParameterMap& params)
 {
     DeciderVlc* dec = new DeciderVlc(this, this, minPowerLevel, bitrate, findHost()->getIndex(), collectCollisionStatistics);
+    dec->setDebug(debug);
+    dec->setTraceRing(traceRing.get());
+
+    // optional, interpolates packet delivery ratios instead of computing them for every frame
+    ParameterMap::iterator it = params.find("usePdrTable");
+    if (it != params.end() && it->second.boolValue()) {
+        double tolerance = 1e-6;
+        it = params.find("pdrTableTolerance");
+        if (it != params.end()) {
+            tolerance = it->second.doubleValue();
+        }
+        dec->setPdrTable(OokPdrTable::get(tolerance));
+    }
     return unique_ptr<DeciderVlc>(std::move(dec));
 }
 
@@ -310,15 +270,17 @@ void PhyLayerVlc::handleMessage(cMessage* msg)
     }
     else if (msg->getKind() == AIR_FRAME) {
         AirFrameVlc* VlcMsg = check_and_cast<AirFrameVlc*>(msg);
-        std::string txNode = VlcMsg->getSenderModule()->getModuleByPath("^.^.")->getFullName();
-        if (txNode == getModuleByPath("^.^.")->getFullName()) {
+        // the VlcConnectionManager does not connect nics of the same car, other connection managers might
+        if (VlcMsg->getSenderHostId() == hostId) {
             EV_TRACE << "Discarding received AirFrameVlc within the same host: " << VlcMsg->getSenderModule()->getFullPath() << std::endl;
             delete msg;
             return;
         }
         else {
             EV_TRACE << "AirFrameVlc id: " << VlcMsg->getId() << " handed to VLC PHY from: " << VlcMsg->getSenderModule()->getFullPath() << std::endl;
-            bubble("Handing AirFrameVlc to lower layers to decide if it can be received");
+            if (hasGUI()) {
+                bubble("Handing AirFrameVlc to lower layers to decide if it can be received");
+            }
             BasePhyLayer::handleAirFrame(static_cast<AirFrame*>(msg));
         }
     }
@@ -349,6 +311,7 @@ unique_ptr<AirFrame> PhyLayerVlc::encapsMsg(cPacket* macPkt)
     frame->setProtocolId(myProtocolId());
     frame->setId(world->getUniqueAirFrameId());
     frame->setChannel(radio->getCurrentChannel());
+    frame->setSenderHostId(hostId);
 
     // encapsulate the mac packet into the phy frame
     frame->encapsulate(macPkt);
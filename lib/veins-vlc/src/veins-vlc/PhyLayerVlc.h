@@ -31,10 +31,10 @@
 
 #include "veins-vlc/analogueModel/EmpiricalLightModel.h"
 #include "veins-vlc/utility/ConstsVlc.h"
+#include "veins-vlc/utility/Trace.h"
 
 #include "veins-vlc/analogueModel/LsvLightModel.h"
-#include "veins-vlc/RadiationPattern.h"
-#include "veins-vlc/Photodiode.h"
+#include "veins-vlc/LightDatabase.h"
 
 namespace veins {
 
@@ -53,10 +53,19 @@ namespace veins {
 class PhyLayerVlc : public BasePhyLayer {
 public:
     void initialize(int stage) override;
+    void finish() override;
 
-    static bool mapsInitialized;
-    static std::map<std::string, RadiationPattern> radiationPatternMap;
-    static std::map<std::string, Photodiode> photodiodeMap;
+    /** @brief HEAD or TAIL depending on the antenna of this phy, 0 if it is neither.*/
+    int getLightingModuleOrientation() const
+    {
+        return lightingModuleOrientation;
+    }
+
+    /** @brief Module id of the car this phy belongs to, shared by all its lighting modules.*/
+    int getHostId() const
+    {
+        return hostId;
+    }
 
 protected:
     /** @brief enable/disable detection of packet collisions */
@@ -67,6 +76,21 @@ protected:
 
     double bitrate;
 
+    /** @brief Radiation patterns and photodiodes, only loaded for the LsvLightModel.*/
+    std::shared_ptr<const LightDatabase> lightDatabase;
+
+    /** @brief Trace log of the light models and decider, compiled away in release builds without trace.*/
+    bool debug = false;
+
+    /** @brief Binary trace of the light models and decider, if enabled.*/
+    std::shared_ptr<TraceRing> traceRing;
+
+    /** @brief HEAD or TAIL, set when the antenna is created.*/
+    int lightingModuleOrientation = 0;
+
+    /** @brief Module id of the car, set before the nic registers with the connection manager.*/
+    int hostId = -1;
+
     enum ProtocolIds {
         VLC = 12124
     };
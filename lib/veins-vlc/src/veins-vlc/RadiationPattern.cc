@@ -19,39 +19,42 @@
 //
 
 #include "veins-vlc/RadiationPattern.h"
-/**
-   RadiationPattern::RadiationPattern(std::string m_id, std::vector<double> m_patternLeft, std::vector<double> m_patternRight, std::vector<double> m_anglesLeft, std::vector<double> m_anglesRight, std::vector<double> m_spectralEmission) {
-    id = m_id;
-    patternLeft = m_patternLeft;
-    patternRight = m_patternRight;
-    anglesLeft = m_anglesLeft;
-    anglesRight = m_anglesRight;
-    spectralEmission = m_spectralEmission;
-   }
 
-   RadiationPattern::~RadiationPattern(){}
- */
-std::vector<double>& RadiationPattern::getSpectralEmission()
+#include <algorithm>
+#include <cmath>
+const LightValues& RadiationPattern::getSpectralEmission() const
 {
     return spectralEmission;
 }
 
-double RadiationPattern::getPatternLeftFromIndex(int index)
+double RadiationPattern::getPatternLeftFromIndex(int index) const
 {
     return patternLeft[index];
 }
 
-double RadiationPattern::getPatternRightFromIndex(int index)
+double RadiationPattern::getPatternRightFromIndex(int index) const
 {
     return patternRight[index];
 }
 
-double RadiationPattern::getAnglesLeftFromIndex(int index)
+double RadiationPattern::getAnglesLeftFromIndex(int index) const
 {
     return anglesLeft[index];
 }
 
-double RadiationPattern::getAnglesRightFromIndex(int index)
+double RadiationPattern::getAnglesRightFromIndex(int index) const
 {
     return anglesRight[index];
 }
+
+double RadiationPattern::calcCosMaxHorizontalAngle() const
+{
+    // angles are given in degrees, horizontal ones from index 0 to 1
+    double maxAngle = 0;
+    for (const auto* angles : {&anglesLeft, &anglesRight}) {
+        if (angles->size() > 1) {
+            maxAngle = std::max({maxAngle, std::fabs((*angles)[0]), std::fabs((*angles)[1])});
+        }
+    }
+    return std::cos(maxAngle * M_PI / 180);
+}
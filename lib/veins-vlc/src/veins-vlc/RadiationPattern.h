@@ -20,32 +20,39 @@
 
 #pragma once
 
-#include <string>
-#include <vector>
+#include "veins-vlc/utility/LightValues.h"
 
+/**
+ * Radiation pattern of a light, its values are owned by the LightDatabase it is stored in.
+ */
 class RadiationPattern {
 public:
-    RadiationPattern(std::string m_id, std::vector<double> m_patternLeft, std::vector<double> m_patternRight, std::vector<double> m_anglesLeft, std::vector<double> m_anglesRight, std::vector<double> m_spectralEmission)
-        : id(m_id)
-        , patternLeft(m_patternLeft)
+    RadiationPattern(LightValues m_patternLeft, LightValues m_patternRight, LightValues m_anglesLeft, LightValues m_anglesRight, LightValues m_spectralEmission)
+        : patternLeft(m_patternLeft)
         , patternRight(m_patternRight)
         , anglesLeft(m_anglesLeft)
         , anglesRight(m_anglesRight)
-        , spectralEmission(m_spectralEmission){};
+        , spectralEmission(m_spectralEmission)
+        , cosMaxHorizontalAngle(calcCosMaxHorizontalAngle()){};
 
-    //    ~RadiationPattern();
-
-    std::vector<double>& getSpectralEmission();
-    double getPatternLeftFromIndex(int index);
-    double getPatternRightFromIndex(int index);
-    double getAnglesLeftFromIndex(int index);
-    double getAnglesRightFromIndex(int index);
+    const LightValues& getSpectralEmission() const;
+    double getPatternLeftFromIndex(int index) const;
+    double getPatternRightFromIndex(int index) const;
+    double getAnglesLeftFromIndex(int index) const;
+    double getAnglesRightFromIndex(int index) const;
+    // cosine of the widest horizontal angle either light module emits at, negative if it shines backwards
+    double getCosMaxHorizontalAngle() const
+    {
+        return cosMaxHorizontalAngle;
+    }
 
 private:
-    std::string id;
-    std::vector<double> patternLeft;
-    std::vector<double> patternRight;
-    std::vector<double> anglesLeft;
-    std::vector<double> anglesRight;
-    std::vector<double> spectralEmission;
+    LightValues patternLeft;
+    LightValues patternRight;
+    LightValues anglesLeft;
+    LightValues anglesRight;
+    LightValues spectralEmission;
+    double cosMaxHorizontalAngle;
+
+    double calcCosMaxHorizontalAngle() const;
 };
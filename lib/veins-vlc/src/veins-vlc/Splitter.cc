@@ -60,7 +60,7 @@ void Splitter::initialize()
     vlcPhys = getSubmodulesOfType<PhyLayerVlc>(getParentModule(), true);
     ASSERT(vlcPhys.size() > 0);
 
-    annotationManager = AnnotationManagerAccess().getIfExists();
+    annotationManager = AnnotationManagerAccess().getIfExists(this);
     ASSERT(annotationManager);
 }
 
@@ -90,8 +90,11 @@ void Splitter::handleMessage(cMessage* msg)
 void Splitter::handleUpperMessage(cMessage* msg)
 {
     unique_ptr<BaseFrame1609_4> wsm(check_and_cast<BaseFrame1609_4*>(msg));
-    const auto accessTechnology = getAccessTechnology(wsm.get());
+    sendViaInterfaces(wsm.get(), getAccessTechnology(wsm.get()));
+}
 
+void Splitter::sendViaInterfaces(BaseFrame1609_4* wsm, Interfaces accessTechnology)
+{
     if (accessTechnology.test(Splitter::Interface::dsrc)) {
         EV_INFO << "DSRC message received from upper layer!" << std::endl;
         send(wsm->dup(), toDsrcNic);
@@ -26,6 +26,7 @@
 #include "veins/base/utils/EnumBitset.h"
 #include "veins/modules/utility/TimerManager.h"
 #include "veins/modules/world/annotations/AnnotationManager.h"
+#include "veins/modules/messages/BaseFrame1609_4_m.h"
 
 #include "veins-vlc/PhyLayerVlc.h"
 
@@ -88,6 +89,7 @@ protected:
     virtual void handleUpperMessage(cMessage* msg);
     virtual void handleLowerMessage(cMessage* msg);
     virtual Interfaces getAccessTechnology(cPacket *msg);
+    void sendViaInterfaces(BaseFrame1609_4* wsm, Interfaces accessTechnology); // sends copies of wsm to all selected NICs
 
     void drawRayLine(const AntennaPosition& ap, int length, double halfAngle, bool reverse = false);
 };
@@ -23,6 +23,7 @@
 #include <cmath>
 
 #include "veins/base/modules/BaseWorldUtility.h"
+#include "veins-vlc/PhyLayerVlc.h"
 
 Define_Module(veins::VlcConnectionManager);
 
@@ -34,3 +35,55 @@ double VlcConnectionManager::calcInterfDist()
     // there communication is not possible above 350 m, so this presents an upper-bound
     return 380;
 }
+
+void VlcConnectionManager::initialize(int stage)
+{
+    if (stage == 0) {
+        directionalCulling = par("directionalCulling");
+        headlightMaxRange = par("headlightMaxRange");
+        headlightCosHalfAngle = cos(par("headlightHalfAngle").doubleValueInUnit("rad"));
+        taillightMaxRange = par("taillightMaxRange");
+        taillightCosHalfAngle = cos(par("taillightHalfAngle").doubleValueInUnit("rad"));
+        cullingMargin = par("cullingMargin");
+        directionalRange = directionalCulling;
+    }
+    BaseConnectionManager::initialize(stage);
+    if (stage == 0 && directionalCulling && useTorus) {
+        throw cRuntimeError("directionalCulling does not support a torus playground");
+    }
+}
+
+void VlcConnectionManager::finish()
+{
+    BaseConnectionManager::finish();
+    if (directionalCulling) {
+        recordScalar("directionalCullingChecks", getFramesChecked());
+        recordScalar("directionalCullingRejected", getFramesRejected());
+    }
+}
+
+bool VlcConnectionManager::isInRange(NicEntries::mapped_type pFromNic, NicEntries::mapped_type pToNic)
+{
+    if (!BaseConnectionManager::isInRange(pFromNic, pToNic)) return false;
+
+    const auto fromPhy = dynamic_cast<PhyLayerVlc*>(pFromNic->chAccess);
+    const auto toPhy = dynamic_cast<PhyLayerVlc*>(pToNic->chAccess);
+    // the lighting modules of a car never receive each other, PhyLayerVlc would discard the frames
+    if (fromPhy && toPhy && fromPhy->getHostId() == toPhy->getHostId()) return false;
+    if (!directionalCulling) return true;
+
+    const int txOrientation = fromPhy ? fromPhy->getLightingModuleOrientation() : 0;
+    const int rxOrientation = toPhy ? toPhy->getLightingModuleOrientation() : 0;
+    if (txOrientation == 0 || rxOrientation == 0) return true;
+
+    // same vectors as the light models derive from the orientation of the sender and receiver
+    const Coord txHeading = pFromNic->heading.toCoord() * txOrientation;
+    const Coord rxHeading = pToNic->heading.toCoord() * rxOrientation;
+    return !rejectsGeometry(pToNic->pos - pFromNic->pos, txHeading, rxHeading, txOrientation == HEAD);
+}
+
+bool VlcConnectionManager::rejectsGeometry(const Coord& tx2Rx, const Coord& txHeading, const Coord& rxHeading, bool isHead)
+{
+    const double maxRange = isHead ? headlightMaxRange : taillightMaxRange;
+    return rejectEarly(tx2Rx, txHeading, rxHeading, isHead ? headlightCosHalfAngle : taillightCosHalfAngle, maxRange > 0 ? maxRange : std::numeric_limits<double>::infinity(), cullingMargin);
+}
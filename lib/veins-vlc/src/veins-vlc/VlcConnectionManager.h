@@ -23,6 +23,7 @@
 #include "veins-vlc/veins-vlc.h"
 
 #include "veins/base/connectionManager/BaseConnectionManager.h"
+#include "veins-vlc/analogueModel/GeometryPrecheck.h"
 
 namespace veins {
 
@@ -34,10 +35,29 @@ namespace veins {
  * power, wavelength, pathloss coefficient and a threshold for the
  * minimal receive Power.
  *
+ * Unless directionalCulling is disabled, a nic is only connected to the nics
+ * that lie within the range and emission cone of its lighting module and
+ * whose photodiode faces it, so frames are not even delivered to receivers
+ * the light models would discard. Connections are thus no longer symmetric.
+ *
+ * Nics of the same car are never connected.
+ *
  * @ingroup connectionManager
  */
-class VEINS_VLC_API VlcConnectionManager : public BaseConnectionManager {
+class VEINS_VLC_API VlcConnectionManager : public BaseConnectionManager, private GeometryPrecheck {
+public:
+    void initialize(int stage) override;
+    void finish() override;
+
 protected:
+    bool directionalCulling;
+    double headlightMaxRange;
+    double headlightCosHalfAngle;
+    double taillightMaxRange;
+    double taillightCosHalfAngle;
+    /** @brief How far the light modules and photodiodes may be offset from the reported nic position.*/
+    double cullingMargin;
+
     /**
      * @brief Calculate interference distance
      *
@@ -48,7 +68,18 @@ protected:
      * You may want to overwrite this function in order to do your own
      * interference calculation
      */
-    virtual double calcInterfDist();
+    double calcInterfDist() override;
+
+    /**
+     * @brief Additionally requires the receiver to be in the cone of the sender
+     * and to face it, and never connects nics of the same car.
+     *
+     * Falls back to the distance check for nics which are not PhyLayerVlc.
+     */
+    bool isInRange(NicEntries::mapped_type pFromNic, NicEntries::mapped_type pToNic) override;
+
+    /** @brief Whether the light of a transmitter at the origin cannot reach a receiver at tx2Rx, see GeometryPrecheck.*/
+    bool rejectsGeometry(const Coord& tx2Rx, const Coord& txHeading, const Coord& rxHeading, bool isHead);
 };
 
 } // namespace veins
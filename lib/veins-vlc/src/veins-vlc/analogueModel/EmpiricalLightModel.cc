@@ -20,6 +20,10 @@
 
 #include "veins-vlc/analogueModel/EmpiricalLightModel.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "veins/base/messages/AirFrame_m.h"
 #include "veins-vlc/messages/AirFrameVlc_m.h"
 #include "veins-vlc/analogueModel/FittedEmpiricalLightModel.h"
@@ -28,8 +32,53 @@
 
 using namespace veins;
 
-#define EV_TRACE \
-    if (debug) EV_LOG(omnetpp::LOGLEVEL_TRACE, nullptr) << "[empiricalLightModel] "
+#define EV_TRACE VEINS_VLC_TRACE_LOG(debug, "[empiricalLightModel] ")
+
+namespace {
+
+/**
+ * Measurements of one lighting module converted to linear mW once, in one flat row-major block.
+ *
+ * Row r holds the values measured at a distance of r + 1 m along the heading of the transmitter,
+ * column c those at a lateral offset of c - xSpan m.
+ */
+template <size_t rows, size_t columns>
+struct LinearLightTable {
+    static constexpr int xSpan = (columns - 1) / 2;
+
+    explicit LinearLightTable(const double (&table_dbm)[rows][columns])
+    {
+        for (size_t row = 0; row < rows; ++row) {
+            for (size_t column = 0; column < columns; ++column) {
+                values_mW[row * columns + column] = FWMath::dBm2mW(table_dbm[row][column]);
+            }
+        }
+    }
+
+    // value measured at the whole metres towards the transmitter, like the original model
+    double nearest_mW(int x, int y) const
+    {
+        const int row = std::min(std::max(y - 1, 0), static_cast<int>(rows) - 1);
+        return values_mW[row * columns + x + xSpan];
+    }
+
+    // bilinear interpolation between the four surrounding measurements
+    double interpolated_mW(double x, double y) const
+    {
+        const double fy = std::min(std::max(y - 1, 0.0), rows - 1.0);
+        const double fx = std::min(std::max(x + xSpan, 0.0), columns - 1.0);
+        const int row = std::min(static_cast<int>(fy), static_cast<int>(rows) - 2);
+        const int column = std::min(static_cast<int>(fx), static_cast<int>(columns) - 2);
+        const double dy = fy - row;
+        const double dx = fx - column;
+        const double* cell = values_mW + row * columns + column;
+        return (cell[0] * (1 - dx) + cell[1] * dx) * (1 - dy) + (cell[columns] * (1 - dx) + cell[columns + 1] * dx) * dy;
+    }
+
+    alignas(64) double values_mW[rows * columns];
+};
+
+} // namespace
 
 // y=100m  x=-50m ~ +50m; PD height = 0.55 m
 // TODO: Use consts instead of hard-coded values
@@ -2017,54 +2066,49 @@ void EmpiricalLightModel::filterSignal(Signal* signal)
     const Coord senderPos2D = sender.pos.getPositionAt().atZ(0);
     const Coord receiverPos2D = receiver.pos.getPositionAt().atZ(0);
 
-    EV_TRACE << "Sender @ 2D: " << senderPos2D.info()
-        << "\tReceiver @ 2D: " << receiverPos2D.info() << std::endl;
-
-    // The heading of the vehicle based on OMNeT angles
-    double txHeading = traci2myAngle(Heading::fromCoord(sender.orientation).getRad());
-    double rxHeading = traci2myAngle(Heading::fromCoord(receiver.orientation).getRad());
-
-    EV_TRACE << "txHeading: " << txHeading
-        << "\trxHeading: " << rxHeading
-        << "\ttxHeading (deg): " << rad2deg(txHeading)
-        << "\trxHeading (deg): " << rad2deg(rxHeading) << std::endl;
-
     // Orientation of the lighting module relative to the vehicle
     int txOrientation = getLightingModuleOrientation(sender);
     int rxOrientation = getLightingModuleOrientation(receiver);
 
+    // Normalized heading vectors of the lighting modules, in OMNeT angles
+    Coord txHeadingVector = headingVector(sender.orientation) * txOrientation;
+    Coord rxHeadingVector = headingVector(receiver.orientation) * rxOrientation;
+
+    // Most receivers are behind the sender or outside its cone, skip everything else for them
+    if (rejectsGeometry(receiverPos2D - senderPos2D, txHeadingVector, rxHeadingVector, txOrientation == HEAD)) {
+        *signal *= 0;
+        return;
+    }
+
+    EV_TRACE << "Sender @ 2D: " << senderPos2D.info()
+        << "\tReceiver @ 2D: " << receiverPos2D.info() << std::endl;
+    EV_TRACE << "txHeadingVector: " << txHeadingVector.info()
+        << "\trxHeadingVector: " << rxHeadingVector.info() << std::endl;
+
     double tx2RxDistance = senderPos2D.distance(receiverPos2D);
 
     // Normalized Vector (calculation of the unit-vector using vector magnitude)
     Coord tx2RxVector = (receiverPos2D - senderPos2D) / tx2RxDistance;
-    // Normalized Vector (calculation of the unit-vector using angles)
-    Coord txHeadingVector = Coord(cos(txHeading), sin(txHeading)) * txOrientation;
-    Coord rxHeadingVector = Coord(cos(rxHeading), sin(rxHeading)) * rxOrientation;
-
-    // Debugging: Drawing a 42 unit heading vector for the sender
-    // annotations->scheduleErase(0.2,annotations->drawLine(senderPos,senderPos + txHeadingVector*42, "pink") );
 
     // Calculating the angle between two vectors using the dot product
     double cosIrradianceAngle = utilTrunc(tx2RxVector * txHeadingVector);
-    double irradianceAngle = rad2deg(acos(cosIrradianceAngle));
     double cosIncidenceAngle = utilTrunc(tx2RxVector * rxHeadingVector);
-    double incidenceAngle = rad2deg(acos(cosIncidenceAngle));
 
     // Debugging
     EV_TRACE << "[Summary]: "
         << "\tDistance = " << tx2RxDistance
-        << "\tIrradiance Angle = +/- " << irradianceAngle
-        << "\tIncidence Angle = +/- " << incidenceAngle << std::endl;
+        << "\tIrradiance Angle = +/- " << rad2deg(acos(cosIrradianceAngle))
+        << "\tIncidence Angle = +/- " << rad2deg(acos(cosIncidenceAngle)) << std::endl;
 
     //    // atan2 method for checking FOV
     //    double headingTan = atan2(vectorTxHeading.y, vectorTxHeading.x);
     //    double rxTxTan = atan2((receiverPos - senderPos).y, (receiverPos - senderPos).x);
 
-    double receivedPower_dbm = sensitivity_dbm; // Default return value if any of the inner conditions fails
+    double receivedPower_mW = 0; // Default return value if any of the inner conditions fails
     switch (txOrientation) {
     case HEAD: {
         bool inTxRange = tx2RxDistance <= headlightMaxTxRange;
-        bool inTxFov = ((receiverPos2D - senderPos2D) / cos(headlightMaxTxAngle)) * txHeadingVector >= tx2RxDistance;
+        bool inTxFov = ((receiverPos2D - senderPos2D) / cosHeadlightMaxTxAngle) * txHeadingVector >= tx2RxDistance;
         bool inTxBearing = cosIncidenceAngle < 0;
 
         // Debug messages
@@ -2097,18 +2141,18 @@ void EmpiricalLightModel::filterSignal(Signal* signal)
             EV_TRACE << "Message can be received: Angle & Bearing are OK" << std::endl;
             if (inTxRange) {
                 EV_TRACE << "Within range of the measurement, receiving via Empirical Model" << std::endl;
-                receivedPower_dbm = calcReceivedPower(txOrientation, tx2RxDistance, tx2RxVector, txHeadingVector, rxHeadingVector);
+                receivedPower_mW = calcReceivedPower_mW(txOrientation, tx2RxDistance, tx2RxVector, txHeadingVector, rxHeadingVector);
             }
             else {
                 EV_TRACE << "Beyond the range of the measurements, receiving via Fitted Empirical Model" << std::endl;
-                receivedPower_dbm = calcFittedReceivedPower(tx2RxDistance, tx2RxVector, txHeadingVector);
+                receivedPower_mW = FWMath::dBm2mW(calcFittedReceivedPower(tx2RxDistance, tx2RxVector, txHeadingVector));
             }
         }
         break;
     }
     case TAIL: {
         bool inTxRange = tx2RxDistance <= taillightMaxTxRange;
-        bool inTxFov = ((receiverPos2D - senderPos2D) / cos(taillightMaxTxAngle)) * txHeadingVector >= tx2RxDistance;
+        bool inTxFov = ((receiverPos2D - senderPos2D) / cosTaillightMaxTxAngle) * txHeadingVector >= tx2RxDistance;
         bool inTxBearing = cosIncidenceAngle < 0;
 
         // Debug messages
@@ -2135,7 +2179,7 @@ void EmpiricalLightModel::filterSignal(Signal* signal)
         // Calculating receiving power
         if (inTxRange && inTxFov && inTxBearing) {
             EV_TRACE << "Message can be received!" << std::endl;
-            receivedPower_dbm = calcReceivedPower(txOrientation, tx2RxDistance, tx2RxVector, txHeadingVector, rxHeadingVector);
+            receivedPower_mW = calcReceivedPower_mW(txOrientation, tx2RxDistance, tx2RxVector, txHeadingVector, rxHeadingVector);
         }
         else {
             EV_TRACE << "The message can not be received!" << std::endl;
@@ -2148,18 +2192,17 @@ void EmpiricalLightModel::filterSignal(Signal* signal)
     }
     }
 
-    double receivedPower_mW = FWMath::dBm2mW(receivedPower_dbm);
-    EV_TRACE << "receivedPower_dbm: " << receivedPower_dbm
+    EV_TRACE << "receivedPower_dbm: " << FWMath::mW2dBm(receivedPower_mW)
         << "\treceivedPower_mW: " << receivedPower_mW
         << "\tsensitivity_dbm: " << sensitivity_dbm << std::endl;
 
     double attenuationFactor;
-    if (receivedPower_dbm <= sensitivity_dbm) {
+    if (receivedPower_mW <= sensitivity_mW) {
         // The conditions above have not been fulfilled; 100% attenuation
         attenuationFactor = 0;
     }
     else {
-        attenuationFactor = FWMath::dBm2mW(receivedPower_dbm) / FIXED_REFERENCE_POWER_MW;
+        attenuationFactor = receivedPower_mW / FIXED_REFERENCE_POWER_MW;
     }
 
     EV_TRACE << "attenuationFactor_linear: " << attenuationFactor << std::endl;
@@ -2167,17 +2210,19 @@ void EmpiricalLightModel::filterSignal(Signal* signal)
     double powerFinal = FIXED_REFERENCE_POWER_MW * attenuationFactor;
     EV_TRACE << "Power [mw & db] after multiplying with the attenuationFactor: [" << powerFinal << " mW & " << FWMath::mW2dBm(powerFinal) << " dbm]" << std::endl;
 
+    if (traceRing) traceRing->record(TraceRing::Event::EmpiricalLightModelPower, owner->getId(), tx2RxDistance, cosIrradianceAngle, receivedPower_mW, attenuationFactor);
+
     *signal *= attenuationFactor;
 }
 
-double EmpiricalLightModel::calcReceivedPower(int txOrientation, double tx2RxDistance, const Coord& tx2RxVector, const Coord& txHeadingVector, const Coord& rxHeadingVector)
+double EmpiricalLightModel::calcReceivedPower_mW(int txOrientation, double tx2RxDistance, const Coord& tx2RxVector, const Coord& txHeadingVector, const Coord& rxHeadingVector)
 {
+    static const LinearLightTable<100, 101> headModel_mW(ccHeadModel);
+    static const LinearLightTable<30, 41> tailModel_mW(ccTailModel);
 
     // cos(emission angle) = cos(incidence angle without considering bearing)
     double cosIrradianceAngle = utilTrunc(tx2RxVector * txHeadingVector);
-    double irradianceAngle_rad = acos(cosIrradianceAngle);
-    double irradianceAngle_deg = rad2deg(irradianceAngle_rad);
-    EV_TRACE << "emissionAngle = " << irradianceAngle_deg << std::endl;
+    EV_TRACE << "emissionAngle = " << rad2deg(acos(cosIrradianceAngle)) << std::endl;
 
     // cos(incidence angle)
     double cosIncidenceAngle = utilTrunc(tx2RxVector * rxHeadingVector) * (-1);
@@ -2188,29 +2233,22 @@ double EmpiricalLightModel::calcReceivedPower(int txOrientation, double tx2RxDis
     bool onLeftOfTx = (txHeadingVector.twoDimensionalCrossProduct(tx2RxVector) < 0);
     if (onLeftOfTx) EV_TRACE << "The receiver is on the left of the sender" << std::endl;
 
-    // relative x,y of Rx to Tx
-    int relativeXaxis = onLeftOfTx ? (-1) * tx2RxDistance * sin(irradianceAngle_rad) : tx2RxDistance* sin(irradianceAngle_rad);
-    int relativeYaxis = tx2RxDistance * cosIrradianceAngle;
-    EV_TRACE << "relative (x,y) of receiver to sender is (" << relativeXaxis << ", " << relativeYaxis << ")" << std::endl; // assuming the Tx is the origin
+    // relative x,y of Rx to Tx, sin(emission angle) follows from its cosine
+    double relativeX = tx2RxDistance * std::sqrt(1 - cosIrradianceAngle * cosIrradianceAngle) * (onLeftOfTx ? -1 : 1);
+    double relativeY = tx2RxDistance * cosIrradianceAngle;
+    EV_TRACE << "relative (x,y) of receiver to sender is (" << relativeX << ", " << relativeY << ")" << std::endl; // assuming the Tx is the origin
 
-    // recvPowertmp
-    // HeadModel[100][101] and TailModel[30][41], filter out those locations from the model
-    double tmpRecvPower = sensitivity_dbm;
+    // HeadModel[100][101] and TailModel[30][41], locations beyond their lateral span get the sensitivity like in the original model
+    double tmpRecvPower_mW = sensitivity_mW;
     switch (txOrientation) {
     case HEAD: {
-        // Are we within the span of the model
-        if (abs(relativeXaxis) <= HEAD_MAX_X_SPAN) {
-            ASSERT((relativeYaxis - 1) >= 0); // -1 because the array starts from 0
-            ASSERT((relativeXaxis + HEAD_MAX_X_SPAN) >= 0);
-            tmpRecvPower = ccHeadModel[relativeYaxis - 1][relativeXaxis + HEAD_MAX_X_SPAN];
-            EV_TRACE << "Query to ccHeadModel[" << relativeYaxis - 1 << "][" << relativeXaxis + HEAD_MAX_X_SPAN << "]=" << tmpRecvPower << std::endl;
+        if (interpolate ? std::abs(relativeX) <= HEAD_MAX_X_SPAN : std::abs(static_cast<int>(relativeX)) <= HEAD_MAX_X_SPAN) {
+            tmpRecvPower_mW = interpolate ? headModel_mW.interpolated_mW(relativeX, relativeY) : headModel_mW.nearest_mW(static_cast<int>(relativeX), static_cast<int>(relativeY));
         }
-        // If condition not fulfilled tmpRecvPower remains -114
     } break;
     case TAIL: {
-        if (abs(relativeXaxis) <= TAIL_MAX_X_SPAN) {
-            tmpRecvPower = ccTailModel[relativeYaxis - 1][relativeXaxis + TAIL_MAX_X_SPAN];
-            EV_TRACE << "Query to ccTailModel[" << relativeYaxis - 1 << "][" << relativeXaxis + TAIL_MAX_X_SPAN << "]=" << tmpRecvPower << std::endl;
+        if (interpolate ? std::abs(relativeX) <= TAIL_MAX_X_SPAN : std::abs(static_cast<int>(relativeX)) <= TAIL_MAX_X_SPAN) {
+            tmpRecvPower_mW = interpolate ? tailModel_mW.interpolated_mW(relativeX, relativeY) : tailModel_mW.nearest_mW(static_cast<int>(relativeX), static_cast<int>(relativeY));
         }
     } break;
     default: {
@@ -2218,13 +2256,13 @@ double EmpiricalLightModel::calcReceivedPower(int txOrientation, double tx2RxDis
         break;
     }
     }
+    EV_TRACE << "Query to the measurements of the " << (txOrientation == HEAD ? "headlight" : "taillight") << " = " << tmpRecvPower_mW << "(mW)" << std::endl;
 
-    double tmpRecvPower_mw = FWMath::dBm2mW(tmpRecvPower);
     // Eq (4) from "Characterizing Link Asymmetry in Vehicle-to-Vehicle Visible Light Communications"
-    double recvPower = FWMath::mW2dBm(tmpRecvPower_mw * (cosIncidenceAngle / cosIrradianceAngle));
-    EV_TRACE << "&& recvPower after considering bearing = " << recvPower << "(dBm)" << std::endl;
+    double recvPower_mW = tmpRecvPower_mW * (cosIncidenceAngle / cosIrradianceAngle);
+    EV_TRACE << "&& recvPower after considering bearing = " << recvPower_mW << "(mW)" << std::endl;
 
-    return recvPower;
+    return recvPower_mW;
 }
 
 double EmpiricalLightModel::calcFittedReceivedPower(double tx2RxDistance, const Coord& tx2RxVector, const Coord& txHeadingVector)
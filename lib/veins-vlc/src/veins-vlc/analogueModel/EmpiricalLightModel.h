@@ -25,13 +25,16 @@
 #include <cassert>
 
 #include "veins-vlc/veins-vlc.h"
+#include "veins-vlc/analogueModel/GeometryPrecheck.h"
 
 #include "veins/base/phyLayer/AnalogueModel.h"
 #include "veins-vlc/utility/ConstsVlc.h"
 #include "veins/modules/mobility/traci/TraCIMobility.h"
 #include "veins/modules/world/annotations/AnnotationManager.h"
+#include "veins-vlc/utility/Trace.h"
 #include "veins-vlc/utility/Utils.h"
 #include "veins/base/utils/POA.h"
+#include "veins/base/utils/FWMath.h"
 
 using veins::AirFrame;
 using veins::AnnotationManager;
@@ -40,11 +43,6 @@ using veins::TraCIMobility;
 
 namespace veins {
 
-#define ELMDEBUG(word)                                 \
-    if (debug) {                                       \
-        std::cout << "\t\tELM: " << word << std::endl; \
-    }
-
 /**
  * @brief This class returns the received power in dbm on the
  * receiving module, based on the empirical measurements
@@ -53,21 +51,26 @@ namespace veins {
  * The values are recorded as observed from the spectrum analyzer
  * to which the PD is connected -- this is electrical power
  */
-class VEINS_VLC_API EmpiricalLightModel : public AnalogueModel {
+class VEINS_VLC_API EmpiricalLightModel : public AnalogueModel, public GeometryPrecheck {
 protected:
-    AnnotationManager* annotations;
-
     bool debug = false;
+    TraceRing* traceRing = nullptr;
     double sensitivity_dbm;
+    double sensitivity_mW;
+    bool interpolate; // interpolate between the measurements instead of using the one at the whole metres towards the transmitter
     double headlightMaxTxRange;
     double taillightMaxTxRange;
     double headlightMaxTxAngle;
     double taillightMaxTxAngle;
+    double cosHeadlightMaxTxAngle;
+    double cosTaillightMaxTxAngle;
 
 public:
-    EmpiricalLightModel(cComponent* owner, double rxSensitivity_dbm, double m_headlightMaxTxRange, double m_taillightMaxTxRange, double m_headlightMaxTxAngle, double m_taillightMaxTxAngle)
+    EmpiricalLightModel(cComponent* owner, double rxSensitivity_dbm, double m_headlightMaxTxRange, double m_taillightMaxTxRange, double m_headlightMaxTxAngle, double m_taillightMaxTxAngle, bool m_interpolate = false)
         : AnalogueModel(owner)
         , sensitivity_dbm(rxSensitivity_dbm)
+        , sensitivity_mW(FWMath::dBm2mW(rxSensitivity_dbm))
+        , interpolate(m_interpolate)
         , headlightMaxTxRange(m_headlightMaxTxRange)
         , taillightMaxTxRange(m_taillightMaxTxRange)
         , headlightMaxTxAngle(m_headlightMaxTxAngle)
@@ -76,17 +79,41 @@ public:
         // Transform degrees into radians
         headlightMaxTxAngle = deg2rad(headlightMaxTxAngle);
         taillightMaxTxAngle = deg2rad(taillightMaxTxAngle);
-
-        annotations = AnnotationManagerAccess().getIfExists();
-        ASSERT(annotations);
+        cosHeadlightMaxTxAngle = cos(headlightMaxTxAngle);
+        cosTaillightMaxTxAngle = cos(taillightMaxTxAngle);
     };
 
     void filterSignal(Signal*) override;
 
+    /** @brief Enables the trace log of every frame, unless compiled away.*/
+    void setDebug(bool enabled)
+    {
+        debug = enabled;
+    }
+
+    /** @brief Records the outcome of every frame in ring, nullptr to stop.*/
+    void setTraceRing(TraceRing* ring)
+    {
+        traceRing = ring;
+    }
+
     int getLightingModuleOrientation(POA poa);
 
+protected:
+    /**
+     * @brief The precheck of filterSignal, see GeometryPrecheck.
+     *
+     * The fitted model continues the headlight beyond the measured headlightMaxTxRange, so only the taillight range applies.
+     */
+    bool rejectsGeometry(const Coord& tx2Rx, const Coord& txHeading, const Coord& rxHeading, bool isHead)
+    {
+        return rejectEarly(tx2Rx, txHeading, rxHeading, isHead ? cosHeadlightMaxTxAngle : cosTaillightMaxTxAngle, isHead ? std::numeric_limits<double>::infinity() : taillightMaxTxRange);
+    }
+
+public:
+
     bool isRecvPowerUnderSensitivity(int senderHeading, double distanceFromSenderToReceiver, const Coord& vectorFromTx2Rx, const Coord& vectorTxHeading, const Coord& vectorRxHeading);
-    double calcReceivedPower(int senderHeading, double distanceFromSenderToReceiver, const Coord& vectorFromTx2Rx, const Coord& vectorTxHeading, const Coord& vectorRxHeading);
+    double calcReceivedPower_mW(int senderHeading, double distanceFromSenderToReceiver, const Coord& vectorFromTx2Rx, const Coord& vectorTxHeading, const Coord& vectorRxHeading);
     double calcFittedReceivedPower(double distanceFromSenderToReceiver, const Coord& vectorFromTx2Rx, const Coord& vectorTxHeading);
 };
 
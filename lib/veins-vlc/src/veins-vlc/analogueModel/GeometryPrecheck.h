@@ -0,0 +1,90 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+#include "veins-vlc/veins-vlc.h"
+
+#include "veins/base/utils/Coord.h"
+
+namespace veins {
+
+/**
+ * @brief Conservative test whether a VLC receiver can get any light from a transmitter at all, without trigonometry.
+ *
+ * Light models run it before their detailed calculations. A frame is only rejected if the detailed
+ * calculation would drop it too, i.e., if the receiver faces away from the transmitter, lies outside
+ * the widest emission cone, or lies beyond the maximum range. Rejections are counted per model.
+ */
+class VEINS_VLC_API GeometryPrecheck {
+public:
+    long getFramesChecked() const
+    {
+        return framesChecked;
+    }
+    long getFramesRejected() const
+    {
+        return framesRejected;
+    }
+
+protected:
+    /**
+     * Unit vector of the heading the light models derive via traci2myAngle(Heading::fromCoord(orientation)).
+     */
+    static Coord headingVector(const Coord& orientation)
+    {
+        const double length = std::sqrt(orientation.x * orientation.x + orientation.y * orientation.y);
+        return Coord(orientation.x / length, orientation.y / length);
+    }
+
+    /**
+     * @param tx2Rx 2D vector from the transmitter to the receiver
+     * @param txHeading unit vector the light of the transmitter points to
+     * @param rxHeading unit vector the photodiode of the receiver faces
+     * @param cosMaxAngle cosine of the widest emission angle, the cone is not checked if negative
+     * @param maxRange beyond which nothing is received
+     * @param lateralSlack how far the light modules may be offset sideways from the transmitter position
+     */
+    bool rejectEarly(const Coord& tx2Rx, const Coord& txHeading, const Coord& rxHeading, double cosMaxAngle, double maxRange = std::numeric_limits<double>::infinity(), double lateralSlack = 0)
+    {
+        ++framesChecked;
+        const double facing = tx2Rx.x * rxHeading.x + tx2Rx.y * rxHeading.y;
+        const double ahead = tx2Rx.x * txHeading.x + tx2Rx.y * txHeading.y;
+        const double distanceSquared = tx2Rx.x * tx2Rx.x + tx2Rx.y * tx2Rx.y;
+        const bool facesAway = facing > lateralSlack + tolerance;
+        const bool outOfRange = distanceSquared > (maxRange + lateralSlack + tolerance) * (maxRange + lateralSlack + tolerance);
+        // a module offset sideways is at least distance - lateralSlack away from the receiver
+        const bool outOfCone = cosMaxAngle >= 0 && ahead < (std::sqrt(distanceSquared) - lateralSlack) * cosMaxAngle - tolerance;
+        const bool rejected = facesAway || outOfRange || outOfCone;
+        framesRejected += rejected;
+        return rejected;
+    }
+
+private:
+    static constexpr double tolerance = 1e-6; // m, covers rounding differences to the detailed calculation
+
+    long framesChecked = 0;
+    long framesRejected = 0;
+};
+
+} // namespace veins
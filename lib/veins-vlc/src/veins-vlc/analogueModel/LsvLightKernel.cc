@@ -0,0 +1,102 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "veins-vlc/analogueModel/LsvLightKernel.h"
+
+#include <cmath>
+
+#include "veins-vlc/utility/ConstsVlc.h"
+#include "veins-vlc/utility/Utils.h"
+
+using namespace veins;
+
+LsvLightKernel::LsvLightKernel(const RadiationPattern& radiationPattern, const Transmitter& transmitter)
+    : radiationPattern(radiationPattern)
+    , heading(transmitter.heading)
+    , modules{makeModule(true, transmitter), makeModule(false, transmitter)}
+{
+}
+
+LsvLightKernel::Module LsvLightKernel::makeModule(bool left, const Transmitter& transmitter) const
+{
+    auto angle = [&](int index) {
+        return left ? radiationPattern.getAnglesLeftFromIndex(index) : radiationPattern.getAnglesRightFromIndex(index);
+    };
+
+    Module module;
+    module.left = left;
+
+    // rotate the lateral offset of the module by the heading of the vehicle
+    const double deltaY = (left ? -1 : 1) * transmitter.interModuleDistance / 2;
+    module.position = transmitter.position;
+    module.position.x += (0 * cos(transmitter.headingAngle) - deltaY * sin(transmitter.headingAngle));
+    module.position.y += (0 * sin(transmitter.headingAngle) + deltaY * cos(transmitter.headingAngle));
+
+    module.phiMin = angle(0);
+    module.phiMax = angle(1);
+    module.phiStep = angle(2);
+    module.thetaMin = angle(3);
+    module.thetaMax = angle(4);
+    module.thetaStep = angle(5);
+    module.rowLength = int(round((module.phiMax - module.phiMin + module.phiStep) / module.phiStep));
+    return module;
+}
+
+double LsvLightKernel::modulePower_mW(const Module& module, double x, double y, double z, double headingX, double headingY, double photocurrentFactor) const
+{
+    const double dx = x - module.position.x;
+    const double dy = y - module.position.y;
+    const double dz = z - module.position.z;
+    const double distance2D = sqrt(dx * dx + dy * dy);
+    const double normX = dx / distance2D;
+    const double normY = dy / distance2D;
+
+    // Angles of the receiver as seen from the light module, negative if it is left of the module
+    const double irradianceThetaRad = atan2(dz, distance2D);
+    double irradiancePhiRad = acos(heading.x * normX + heading.y * normY);
+    if (heading.x * normY - heading.y * normX < 0) {
+        irradiancePhiRad *= -1;
+    }
+    const double irradianceTheta = rad2deg(irradianceThetaRad);
+    const double irradiancePhi = rad2deg(irradiancePhiRad);
+
+    const bool inFov = (irradiancePhi >= module.phiMin) && (irradiancePhi <= module.phiMax) && (irradianceTheta >= module.thetaMin) && (irradianceTheta <= module.thetaMax);
+    const double cosIncidenceAngle = normX * headingX + normY * headingY;
+    const bool inTxBearing = cosIncidenceAngle < 0;
+    if (!inFov || !inTxBearing) {
+        return 0;
+    }
+
+    const int indexPhi = int(round((irradiancePhi - module.phiMin) / module.phiStep));
+    const int indexTheta = int(round((irradianceTheta - module.thetaMin) / module.thetaStep));
+    const int indexFlat = (module.rowLength * indexTheta) + indexPhi;
+    const double matrixValue = module.left ? radiationPattern.getPatternLeftFromIndex(indexFlat) : radiationPattern.getPatternRightFromIndex(indexFlat);
+    const double irradiance = matrixValue / sqrt(dx * dx + dy * dy + dz * dz);
+
+    // photo-current of the tilted photodiode, the area, gain and spectral current factor of which are precomputed
+    const double incidencePhi = acos(cosIncidenceAngle * (-1));
+    const double current = irradiance * cos(irradianceThetaRad) * cos(incidencePhi) * photocurrentFactor;
+    return current * current / 50 * 1000;
+}
+
+double LsvLightKernel::receivedPower_mW(double x, double y, double z, double headingX, double headingY, double photocurrentFactor) const
+{
+    return modulePower_mW(modules[0], x, y, z, headingX, headingY, photocurrentFactor) + modulePower_mW(modules[1], x, y, z, headingX, headingY, photocurrentFactor);
+}
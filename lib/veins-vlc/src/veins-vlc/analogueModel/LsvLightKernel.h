@@ -0,0 +1,69 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include "veins-vlc/veins-vlc.h"
+
+#include "veins/base/utils/Coord.h"
+#include "veins-vlc/RadiationPattern.h"
+
+namespace veins {
+
+/**
+ * @brief Received electrical power of the LsvLightModel, for one transmission and one receiver.
+ *
+ * Both light modules of the sender are evaluated by the same code, with the angles of their
+ * radiation patterns looked up once per transmission.
+ */
+class VEINS_VLC_API LsvLightKernel {
+public:
+    /** @brief The sender of a transmission.*/
+    struct Transmitter {
+        Coord position; // between both light modules
+        double headingAngle; // of the vehicle, see traci2myAngle
+        Coord heading; // unit vector the light points to
+        double interModuleDistance;
+    };
+
+    LsvLightKernel(const RadiationPattern& radiationPattern, const Transmitter& transmitter);
+
+    /** @brief Received power of a receiver at (x, y, z) whose photodiode faces (headingX, headingY).*/
+    double receivedPower_mW(double x, double y, double z, double headingX, double headingY, double photocurrentFactor) const;
+
+private:
+    struct Module {
+        bool left;
+        Coord position;
+        // angles of the pattern in degrees
+        double phiMin, phiMax, phiStep;
+        double thetaMin, thetaMax, thetaStep;
+        int rowLength;
+    };
+
+    const RadiationPattern& radiationPattern;
+    Coord heading;
+    Module modules[2];
+
+    Module makeModule(bool left, const Transmitter& transmitter) const;
+    double modulePower_mW(const Module& module, double x, double y, double z, double headingX, double headingY, double photocurrentFactor) const;
+};
+
+} // namespace veins
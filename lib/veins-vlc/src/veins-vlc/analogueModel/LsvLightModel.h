@@ -23,16 +23,17 @@
 #include <cassert>
 
 #include "veins-vlc/veins-vlc.h"
+#include "veins-vlc/analogueModel/GeometryPrecheck.h"
 
 #include "veins/base/phyLayer/AnalogueModel.h"
 #include "veins-vlc/utility/ConstsVlc.h"
 #include "veins/modules/mobility/traci/TraCIMobility.h"
 #include "veins/modules/world/annotations/AnnotationManager.h"
+#include "veins-vlc/utility/Trace.h"
 #include "veins-vlc/utility/Utils.h"
 
 #include "veins-vlc/PhyLayerVlc.h"
-#include "veins-vlc/Photodiode.h"
-#include "veins-vlc/RadiationPattern.h"
+#include "veins-vlc/LightDatabase.h"
 
 using veins::AirFrame;
 using veins::AnnotationManager;
@@ -51,44 +52,47 @@ namespace veins {
  * to which the PD is connected -- this is electrical power
  */
 
-class VEINS_VLC_API LsvLightModel : public AnalogueModel {
+class VEINS_VLC_API LsvLightModel : public AnalogueModel, public GeometryPrecheck {
 protected:
     AnnotationManager* annotations;
 
-    bool debug = true;
+    bool debug = false;
+    TraceRing* traceRing = nullptr;
     double sensitivity_dbm;
 
 public:
-    LsvLightModel(cComponent* owner, std::map<std::string, RadiationPattern>* RadiationPattern_Map, std::map<std::string, Photodiode>* Photodiode_Map, double sensitivity)
+    LsvLightModel(cComponent* owner, std::shared_ptr<const LightDatabase> lightDatabase, double sensitivity)
         : AnalogueModel(owner)
         , sensitivity_dbm(sensitivity)
-        , RP_Map(RadiationPattern_Map)
-        , PD_Map(Photodiode_Map)
+        , lightDatabase(lightDatabase)
     {
-        annotations = AnnotationManagerAccess().getIfExists();
+        annotations = AnnotationManagerAccess().getIfExists(dynamic_cast<cModule*>(owner));
         ASSERT(annotations);
     };
 
     virtual void filterSignal(Signal* signal) override;
 
+    /** @brief Enables the trace log of every frame, unless compiled away.*/
+    void setDebug(bool enabled)
+    {
+        debug = enabled;
+    }
+
+    /** @brief Records the outcome of every frame in ring, nullptr to stop.*/
+    void setTraceRing(TraceRing* ring)
+    {
+        traceRing = ring;
+    }
+
     virtual bool neverIncreasesPower() override
     {
         return true;
     }
-    RadiationPattern* getRadiationPatternFromKey(std::string key);
-    Photodiode* getPhotodiodeFromKey(std::string key);
-
-    double getFromMatrix(int LeftOrRight, double irradianceTheta, double irradiancePhi);
-    bool inFOV(int LeftOrRight, double irradianceTheta, double irradiancePhi);
-    void rotatePos(Coord& C, double rotAngle, double deltaX, double deltaY, double deltaZ);
-    double getOpticalPower(double irradiance, double incidenceTheta, double incidencePhi);
-    double getElectricalPowermW(double opticalPower);
+
     int getLightingModuleOrientation(POA poa);
-    double getCurrentFactor();
 
-    std::map<std::string, RadiationPattern>* RP_Map;
-    std::map<std::string, Photodiode>* PD_Map;
-    RadiationPattern* RP;
-    Photodiode* PD;
+    std::shared_ptr<const LightDatabase> lightDatabase;
+    const RadiationPattern* RP;
+    double photocurrentFactor; // of RP and the receiving photodiode, see LightDatabase::getPhotocurrentFactor
 };
 } // namespace veins
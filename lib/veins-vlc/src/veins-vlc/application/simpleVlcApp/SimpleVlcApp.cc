@@ -44,14 +44,14 @@ void SimpleVlcApp::initialize(int stage)
         fromLower = findGate("lowerLayerIn");
 
         // Pointers to simulation modules
-        traciManager = TraCIScenarioManagerAccess().get();
+        traciManager = TraCIScenarioManagerAccess().get(this);
         ASSERT(traciManager);
 
         cModule* tmpMobility = getParentModule()->getSubmodule("veinsmobility");
         mobility = dynamic_cast<TraCIMobility*>(tmpMobility);
         ASSERT(mobility);
 
-        annotations = AnnotationManagerAccess().getIfExists();
+        annotations = AnnotationManagerAccess().getIfExists(this);
         ASSERT(annotations);
 
         sumoId = mobility->getExternalId();
@@ -0,0 +1,49 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Read-only view of consecutive values stored in a LightDatabase.
+ */
+struct LightValues {
+    const double* values = nullptr;
+    size_t count = 0;
+
+    double operator[](size_t index) const
+    {
+        return values[index];
+    }
+    size_t size() const
+    {
+        return count;
+    }
+    const double* begin() const
+    {
+        return values;
+    }
+    const double* end() const
+    {
+        return values + count;
+    }
+};
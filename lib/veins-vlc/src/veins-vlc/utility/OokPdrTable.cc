@@ -0,0 +1,104 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "veins-vlc/utility/OokPdrTable.h"
+
+#include <algorithm>
+#include <map>
+
+using namespace veins;
+using omnetpp::cRuntimeError;
+
+namespace {
+
+double logNegLogOkAt(double sqrtSnr)
+{
+    return std::log(-std::log1p(-getOokBer(sqrtSnr * sqrtSnr)));
+}
+
+double normalDensity(double x)
+{
+    return std::exp(-x * x / 2) / std::sqrt(2 * M_PI);
+}
+
+/*
+ * Bound on |g''| over [a, b] with 0 <= a < b, g(x) = log(-log(1 - Q(x))) and Q(x) = getOokBer(x * x).
+ *
+ * Write g = log Q + h(Q) with h(q) = log(-log(1 - q) / q). (log Q)'' is minus the derivative of the
+ * inverse Mills ratio, which lies in (0, 1) (Sampford, 1953). As Q' = -phi and Q'' = x * phi, the
+ * second part contributes h''(Q) * phi^2 + h'(Q) * x * phi. -log(1 - q) / q is a power series with
+ * positive coefficients, so for q <= Q(0) = 1/2 we have 0 <= h' <= 4 * (1 - log(2)) and
+ * |h''| <= 16 * log(2) - 8, their values at q = 1/2.
+ */
+double maxCurvature(double a, double b)
+{
+    const double maxPhi = normalDensity(a);
+    // x * phi(x) increases up to x = 1 and decreases beyond
+    const double maxXPhi = b <= 1 ? b * normalDensity(b) : a >= 1 ? a * normalDensity(a) : normalDensity(1);
+    return 1 + (16 * std::log(2) - 8) * maxPhi * maxPhi + 4 * (1 - std::log(2)) * maxXPhi;
+}
+
+} // namespace
+
+std::shared_ptr<const OokPdrTable> OokPdrTable::get(double tolerance)
+{
+    static std::map<double, std::weak_ptr<const OokPdrTable>> tables;
+
+    auto table = tables[tolerance].lock();
+    if (!table) {
+        table = std::make_shared<const OokPdrTable>(tolerance);
+        tables[tolerance] = table;
+    }
+    return table;
+}
+
+OokPdrTable::OokPdrTable(double tolerance)
+    : tolerance(tolerance)
+{
+    if (!(tolerance > 0 && tolerance < 1)) {
+        throw cRuntimeError("Tolerance of the OOK PDR table must be in (0, 1), got %g", tolerance);
+    }
+
+    // the last point of the table where the BER does not underflow to 0
+    double maxSqrtSnr = 0;
+    while (getOokBer((maxSqrtSnr + 0.5) * (maxSqrtSnr + 0.5)) > 0) {
+        maxSqrtSnr += 0.5;
+    }
+
+    for (inverseStep = 10;; inverseStep *= 2) {
+        const size_t count = static_cast<size_t>(maxSqrtSnr * inverseStep) + 1;
+
+        double curvature = 0;
+        for (size_t i = 0; i + 1 < count; ++i) {
+            curvature = std::max(curvature, maxCurvature(i / inverseStep, (i + 1) / inverseStep));
+        }
+
+        // linear interpolation misses g by at most step^2 / 8 * max|g''| and |d/dg exp(-length * exp(g))| <= 1/e
+        errorBound = curvature / (8 * inverseStep * inverseStep) / M_E;
+        if (errorBound <= tolerance) {
+            logNegLogOk.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                logNegLogOk[i] = logNegLogOkAt(i / inverseStep);
+            }
+            lastIndex = count - 1;
+            break;
+        }
+    }
+}
@@ -0,0 +1,93 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "veins-vlc/veins-vlc.h"
+
+#include "veins-vlc/utility/Utils.h"
+
+namespace veins {
+
+/**
+ * @brief Packet delivery ratio of OOK as computed by getOokPdr(), interpolated from a table.
+ *
+ * The PDR of a packet of length bits is exp(-length * exp(g)) with g = log(-log(1 - BER)), so a
+ * single row of g serves all packet lengths. Whatever the length, the PDR then deviates at most
+ * max|error of g| / e from the exact value. The table is indexed by the square root of the SNR,
+ * over which g is almost a parabola with |g''| < 1.8, and refined until step^2 / 8 * max|g''|,
+ * the error of linear interpolation, keeps this bound within the requested tolerance. The bound
+ * holds in exact arithmetic; rounding adds deviations in the order of 1e-12 to either side.
+ *
+ * Beyond the table the BER underflows and the PDR is 1, as in getOokPdr().
+ */
+class VEINS_VLC_API OokPdrTable {
+public:
+    /**
+     * Returns the table for the given tolerance, creating it if no decider uses it yet.
+     */
+    static std::shared_ptr<const OokPdrTable> get(double tolerance);
+
+    explicit OokPdrTable(double tolerance);
+
+    /**
+     * @param snr linear signal to noise ratio
+     * @param packetLength in bits
+     */
+    double getPdr(double snr, int packetLength) const
+    {
+        const double position = std::sqrt(snr) * inverseStep;
+        if (!(position < lastIndex)) {
+            return position >= lastIndex ? 1.0 : getOokPdr(snr, packetLength);
+        }
+        const size_t index = static_cast<size_t>(position);
+        const double g = logNegLogOk[index] + (logNegLogOk[index + 1] - logNegLogOk[index]) * (position - index);
+        return std::exp(-packetLength * std::exp(g));
+    }
+
+    double getTolerance() const
+    {
+        return tolerance;
+    }
+
+    /** @brief Largest deviation from getOokPdr() for any packet length, up to rounding.*/
+    double getErrorBound() const
+    {
+        return errorBound;
+    }
+
+    size_t size() const
+    {
+        return logNegLogOk.size();
+    }
+
+private:
+    double tolerance;
+    double errorBound;
+    double inverseStep;
+    double lastIndex;
+    std::vector<double> logNegLogOk; // log(-log(1 - BER)) at sqrt(snr) = i / inverseStep
+};
+
+} // namespace veins
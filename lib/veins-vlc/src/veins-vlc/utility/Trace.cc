@@ -0,0 +1,122 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "veins-vlc/utility/Trace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+using namespace veins;
+using omnetpp::cRuntimeError;
+
+namespace {
+
+const char fileMagic[8] = {'V', 'L', 'C', 'T', 'R', 'A', 'C', 'E'};
+const uint32_t fileVersion = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t simtimeScaleExponent;
+    uint64_t recordCount; // records following the header, oldest first
+    uint64_t droppedCount; // older records overwritten in the ring
+};
+
+static_assert(sizeof(FileHeader) == 32, "layout of FileHeader must match bin/veins_vlc_trace");
+static_assert(sizeof(TraceRing::Record) == 48, "layout of Record must match bin/veins_vlc_trace");
+
+/**
+ * Keeps the rings of the current run and writes each of them once after all modules finished.
+ */
+class RingWriter : public omnetpp::cISimulationLifecycleListener {
+public:
+    std::map<std::string, std::shared_ptr<TraceRing>> rings; // by file name
+    bool listening = false;
+
+    void lifecycleEvent(omnetpp::SimulationLifecycleEventType eventType, omnetpp::cObject* details) override
+    {
+        if (eventType == omnetpp::LF_POST_NETWORK_FINISH) {
+            auto finished = std::move(rings);
+            rings.clear();
+            for (const auto& ring : finished) {
+                ring.second->write();
+            }
+        }
+        else if (eventType == omnetpp::LF_PRE_NETWORK_DELETE) {
+            rings.clear(); // the run ended without finishing
+        }
+    }
+
+    void listenerRemoved() override
+    {
+        listening = false;
+    }
+};
+
+} // namespace
+
+std::shared_ptr<TraceRing> TraceRing::open(const std::string& fileName, size_t capacity)
+{
+    static RingWriter writer;
+
+    if (!writer.listening) {
+        omnetpp::getEnvir()->addLifecycleListener(&writer);
+        writer.listening = true;
+    }
+    auto& ring = writer.rings[fileName];
+    if (!ring) {
+        ring = std::make_shared<TraceRing>(fileName, capacity);
+    }
+    return ring;
+}
+
+TraceRing::TraceRing(const std::string& fileName, size_t capacity)
+    : fileName(fileName)
+    , records(capacity)
+{
+    if (capacity == 0) {
+        throw cRuntimeError("Trace ring for %s needs room for at least one record", fileName.c_str());
+    }
+}
+
+void TraceRing::write()
+{
+    if (recorded == lastWritten) {
+        return;
+    }
+    lastWritten = recorded;
+
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw cRuntimeError("Could not open trace file %s", fileName.c_str());
+    }
+    const uint64_t kept = std::min<uint64_t>(recorded, records.size());
+    FileHeader header = {{}, fileVersion, omnetpp::SimTime::getScaleExp(), kept, recorded - kept};
+    std::copy(std::begin(fileMagic), std::end(fileMagic), header.magic);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (uint64_t i = recorded - kept; i < recorded; ++i) {
+        file.write(reinterpret_cast<const char*>(&records[i % records.size()]), sizeof(Record));
+    }
+    if (!file) {
+        throw cRuntimeError("Could not write trace file %s", fileName.c_str());
+    }
+}
@@ -0,0 +1,105 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "veins-vlc/veins-vlc.h"
+
+/**
+ * Trace logging of the VLC models, enabled by the debug parameter of PhyLayerVlc.
+ *
+ * Builds defining VEINS_VLC_NO_TRACE (see ./configure --without-release-trace, which the project
+ * build uses) compile all trace statements away, including the evaluation of their arguments.
+ */
+#ifdef VEINS_VLC_NO_TRACE
+#define VEINS_VLC_TRACE_LOG(enabled, prefix) \
+    if (true) {                             \
+    }                                       \
+    else                                    \
+        EV_LOG(omnetpp::LOGLEVEL_TRACE, nullptr) << prefix
+#else
+#define VEINS_VLC_TRACE_LOG(enabled, prefix) \
+    if (!(enabled)) {                       \
+    }                                       \
+    else                                    \
+        EV_LOG(omnetpp::LOGLEVEL_TRACE, nullptr) << prefix
+#endif
+
+namespace veins {
+
+/**
+ * @brief Ring buffer of binary trace records for the hot paths of the VLC models.
+ *
+ * Recording a value copies a few numbers and never formats anything, only the most
+ * recent records are kept. Rings obtained from open() are written to their file once
+ * all modules finished, which bin/veins_vlc_trace converts to CSV. All modules using the
+ * same file share one ring, telling their records apart by module id.
+ */
+class VEINS_VLC_API TraceRing {
+public:
+    enum class Event : int32_t {
+        EmpiricalLightModelPower = 1, // distance, cosine of the angle off the sender heading, received power [mW], attenuation factor
+        LsvLightModelPower = 2, // distance, 0, received power [mW], attenuation factor
+        DeciderVlcResult = 3, // min SINR, min SNR, received power [dBm], PACKET_OK_RESULT
+    };
+
+    struct Record {
+        int64_t simtimeRaw;
+        Event event;
+        int32_t moduleId;
+        double values[4];
+    };
+
+    /**
+     * Returns the ring writing to fileName, creating it with the given capacity if no module of this run used it yet.
+     */
+    static std::shared_ptr<TraceRing> open(const std::string& fileName, size_t capacity);
+
+    TraceRing(const std::string& fileName, size_t capacity);
+
+    void record(Event event, int moduleId, double value0, double value1 = 0, double value2 = 0, double value3 = 0)
+    {
+        Record& record = records[recorded % records.size()];
+        record.simtimeRaw = omnetpp::simTime().raw();
+        record.event = event;
+        record.moduleId = moduleId;
+        record.values[0] = value0;
+        record.values[1] = value1;
+        record.values[2] = value2;
+        record.values[3] = value3;
+        ++recorded;
+    }
+
+    /** @brief Writes the kept records to the file, only the first call after recording does anything.*/
+    void write();
+
+private:
+    std::string fileName;
+    std::vector<Record> records;
+    uint64_t recorded = 0;
+    uint64_t lastWritten = 0;
+};
+
+} // namespace veins
@@ -130,4 +130,18 @@ double getOokPdr(double snr, int packetLength)
     return std::pow(1 - ber, (double) packetLength);
 }
 
+void getOokPdrs(const double* snr, const int* packetLength, double* pdr, size_t count)
+{
+    // erfc and pow have no vector variants in libm, so only the passes around them vectorise
+    for (size_t i = 0; i < count; ++i) {
+        pdr[i] = std::sqrt(snr[i] / 2.0);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        pdr[i] = 0.5 * erfc(pdr[i]);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        pdr[i] = pdr[i] == 0.0 ? 1.0 : std::pow(1 - pdr[i], (double) packetLength[i]);
+    }
+}
+
 } // namespace veins
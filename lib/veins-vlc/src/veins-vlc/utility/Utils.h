@@ -68,4 +68,7 @@ double getOokBer(double snr);
 
 double getOokPdr(double snr, int packetLength);
 
+// Same as getOokPdr() for count packets at once, the reference for OokPdrTable.
+void getOokPdrs(const double* snr, const int* packetLength, double* pdr, size_t count);
+
 } // namespace veins
@@ -0,0 +1,192 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <set>
+#include <utility>
+
+#include "catch2/catch.hpp"
+#include "testutils/Simulation.h"
+
+#include "veins/base/connectionManager/BaseConnectionManager.h"
+#include "veins/base/connectionManager/NicEntryDirect.h"
+#include "veins-vlc/VlcConnectionManager.h"
+#include "veins-vlc/analogueModel/EmpiricalLightModel.h"
+
+using namespace omnetpp;
+using namespace veins;
+
+namespace {
+
+class TestModule : public cModule {
+};
+
+// connection manager whose range only holds in the directions listed in reaches, like VlcConnectionManager with directionalCulling
+class DirectionalConnectionManager : public BaseConnectionManager {
+public:
+    using BaseConnectionManager::NicEntries;
+    using BaseConnectionManager::updateNicConnections;
+
+    DirectionalConnectionManager()
+    {
+        directionalRange = true;
+    }
+
+    std::set<std::pair<int, int>> reaches; // nic ids of sender and receiver
+
+protected:
+    double calcInterfDist() override
+    {
+        return 380;
+    }
+
+    bool isInRange(NicEntries::mapped_type pFromNic, NicEntries::mapped_type pToNic) override
+    {
+        return reaches.count({pFromNic->nicId, pToNic->nicId}) > 0;
+    }
+};
+
+// nic entry of a module with the radioIn gate that connections lead to
+struct TestNic {
+    TestModule module;
+    NicEntryDirect entry;
+
+    TestNic(cComponent* owner, int nicId)
+        : entry(owner)
+    {
+        module.addGate("radioIn", cGate::INPUT);
+        entry.nicId = nicId;
+        entry.nicPtr = &module;
+    }
+};
+
+// EmpiricalLightModel as configured in the config-vlc.xml of the serpentine scenario
+class TestLightModel : public EmpiricalLightModel {
+public:
+    TestLightModel()
+        : EmpiricalLightModel(nullptr, -114, 100, 30, 45, 60)
+    {
+    }
+
+    using EmpiricalLightModel::rejectsGeometry;
+};
+
+// VlcConnectionManager as configured in the omnetpp.ini of the serpentine scenario
+class TestVlcConnectionManager : public VlcConnectionManager {
+public:
+    TestVlcConnectionManager()
+    {
+        directionalCulling = true;
+        headlightMaxRange = 0;
+        headlightCosHalfAngle = std::cos(M_PI / 4);
+        taillightMaxRange = 30;
+        taillightCosHalfAngle = std::cos(M_PI / 3);
+        cullingMargin = 2;
+    }
+
+    using VlcConnectionManager::rejectsGeometry;
+};
+
+} // namespace
+
+SCENARIO("The VLC connection manager never culls a pair the light model would receive", "[connectionManager]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr));
+    TestVlcConnectionManager manager;
+    TestLightModel model;
+
+    GIVEN("A receiver 150 m ahead of a headlight, beyond the measurements")
+    {
+        const Coord east(1, 0);
+        const Coord west(-1, 0);
+
+        THEN("Both the light model and the connection manager let it receive")
+        {
+            REQUIRE_FALSE(model.rejectsGeometry(Coord(150, 0), east, west, true));
+            REQUIRE_FALSE(manager.rejectsGeometry(Coord(150, 0), east, west, true));
+        }
+    }
+
+    GIVEN("Random positions and headings within the maximum interference distance")
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> offset(-380, 380);
+        std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+
+        THEN("Every pair the light model receives is connected")
+        {
+            long received = 0;
+            for (int i = 0; i < 100000; ++i) {
+                const Coord tx2Rx(offset(rng), offset(rng));
+                const double txAngle = angle(rng);
+                const double rxAngle = angle(rng);
+                const Coord txHeading(std::cos(txAngle), std::sin(txAngle));
+                const Coord rxHeading(std::cos(rxAngle), std::sin(rxAngle));
+                for (bool isHead : {true, false}) {
+                    if (!model.rejectsGeometry(tx2Rx, txHeading, rxHeading, isHead)) {
+                        ++received;
+                        REQUIRE_FALSE(manager.rejectsGeometry(tx2Rx, txHeading, rxHeading, isHead));
+                    }
+                }
+            }
+            REQUIRE(received > 1000);
+        }
+    }
+}
+
+SCENARIO("Directional connection managers connect both directions of a pair independently", "[connectionManager]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr));
+    DirectionalConnectionManager manager;
+    TestNic head(&manager, 1); // headlight of the car behind
+    TestNic tail(&manager, 2); // taillight of the car in front, facing the headlight
+    DirectionalConnectionManager::NicEntries others = {{tail.entry.nicId, &tail.entry}};
+
+    GIVEN("A headlight that reaches the taillight, which does not reach back")
+    {
+        manager.reaches = {{head.entry.nicId, tail.entry.nicId}};
+
+        WHEN("The headlight moves")
+        {
+            manager.updateNicConnections(others, &head.entry);
+
+            THEN("Only head->tail is connected")
+            {
+                REQUIRE(head.entry.isConnected(&tail.entry));
+                REQUIRE_FALSE(tail.entry.isConnected(&head.entry));
+            }
+
+            AND_WHEN("The cars turn, so only the taillight reaches the headlight")
+            {
+                manager.reaches = {{tail.entry.nicId, head.entry.nicId}};
+                manager.updateNicConnections(others, &head.entry);
+
+                THEN("head->tail is disconnected and tail->head connected")
+                {
+                    REQUIRE_FALSE(head.entry.isConnected(&tail.entry));
+                    REQUIRE(tail.entry.isConnected(&head.entry));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,126 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "veins-vlc/analogueModel/LsvLightKernel.h"
+#include "veins-vlc/utility/Utils.h"
+
+using namespace veins;
+
+namespace {
+
+// Radiation pattern from -40 to 40 deg horizontally and -10 to 10 deg vertically in steps of 1 deg
+struct TestPattern {
+    std::vector<double> pattern;
+    std::vector<double> angles{-40, 40, 1, -10, 10, 1};
+    std::vector<double> spectralEmission{1};
+
+    TestPattern()
+    {
+        for (int theta = -10; theta <= 10; ++theta) {
+            for (int phi = -40; phi <= 40; ++phi) {
+                pattern.push_back(1000.0 / (1 + phi * phi + 4 * theta * theta));
+            }
+        }
+    }
+
+    RadiationPattern radiationPattern() const
+    {
+        LightValues patternValues{pattern.data(), pattern.size()};
+        LightValues angleValues{angles.data(), angles.size()};
+        return RadiationPattern(patternValues, patternValues, angleValues, angleValues, LightValues{spectralEmission.data(), spectralEmission.size()});
+    }
+};
+
+struct TestReceiver {
+    Coord position; // of the photodiode
+    Coord heading; // unit vector the photodiode faces
+};
+
+const double photocurrentFactor = 0.025;
+const LsvLightKernel::Transmitter transmitter{Coord(0, 0, 0.8), M_PI / 6, Coord(cos(M_PI / 6), sin(M_PI / 6)), 1.4};
+
+// The calculation of one light module as LsvLightModel did it before the kernel, with the same pattern for both modules
+double referenceModulePower_mW(const RadiationPattern& pattern, double deltaY, const TestReceiver& receiver)
+{
+    Coord sendPos = transmitter.position;
+    sendPos.x += (0 * cos(transmitter.headingAngle) - deltaY * sin(transmitter.headingAngle));
+    sendPos.y += (0 * sin(transmitter.headingAngle) + deltaY * cos(transmitter.headingAngle));
+
+    const Coord tx2RxVec = receiver.position - sendPos;
+    const double tx2Rx2D = (receiver.position.atZ(0) - sendPos.atZ(0)).length();
+    const Coord tx2RxNorm = tx2RxVec.atZ(0) / tx2Rx2D;
+    const double irradianceTheta = atan2(tx2RxVec.z, tx2Rx2D);
+    double irradiancePhi = acos(transmitter.heading * tx2RxNorm);
+    if (transmitter.heading.twoDimensionalCrossProduct(tx2RxNorm) < 0) {
+        irradiancePhi *= -1;
+    }
+
+    const bool inFov = rad2deg(irradiancePhi) >= pattern.getAnglesLeftFromIndex(0) && rad2deg(irradiancePhi) <= pattern.getAnglesLeftFromIndex(1) && rad2deg(irradianceTheta) >= pattern.getAnglesLeftFromIndex(3) && rad2deg(irradianceTheta) <= pattern.getAnglesLeftFromIndex(4);
+    if (!inFov || tx2RxNorm * receiver.heading >= 0) {
+        return 0;
+    }
+
+    const double incidencePhi = acos((tx2RxNorm * receiver.heading) * (-1));
+    const int indexPhi = int(round((rad2deg(irradiancePhi) - pattern.getAnglesLeftFromIndex(0)) / pattern.getAnglesLeftFromIndex(2)));
+    const int indexTheta = int(round((rad2deg(irradianceTheta) - pattern.getAnglesLeftFromIndex(3)) / pattern.getAnglesLeftFromIndex(5)));
+    const int rowLength = int(round((pattern.getAnglesLeftFromIndex(1) - pattern.getAnglesLeftFromIndex(0) + pattern.getAnglesLeftFromIndex(2)) / pattern.getAnglesLeftFromIndex(2)));
+    const double irradiance = pattern.getPatternLeftFromIndex((rowLength * indexTheta) + indexPhi) / tx2RxVec.length();
+    const double current = irradiance * cos(irradianceTheta) * cos(incidencePhi) * photocurrentFactor;
+    return current * current / 50 * 1000;
+}
+
+} // namespace
+
+SCENARIO("LsvLightKernel matches the per-module calculation it replaced", "[lsvLightKernel]")
+{
+    TestPattern testPattern;
+    RadiationPattern radiationPattern = testPattern.radiationPattern();
+    LsvLightKernel kernel(radiationPattern, transmitter);
+
+    GIVEN("Receivers scattered around the transmitter, facing random directions")
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> position(-100, 100);
+        std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+        std::vector<TestReceiver> receivers;
+        for (size_t i = 0; i < 10000; ++i) {
+            const double heading = angle(rng);
+            receivers.push_back({Coord(position(rng), position(rng), 0.6), Coord(cos(heading), sin(heading))});
+        }
+
+        THEN("Each received power equals the sum of both modules of the previous calculation")
+        {
+            size_t received = 0;
+            for (const auto& receiver : receivers) {
+                const double power_mW = kernel.receivedPower_mW(receiver.position.x, receiver.position.y, receiver.position.z, receiver.heading.x, receiver.heading.y, photocurrentFactor);
+                const double expected_mW = referenceModulePower_mW(radiationPattern, -transmitter.interModuleDistance / 2, receiver) + referenceModulePower_mW(radiationPattern, transmitter.interModuleDistance / 2, receiver);
+                REQUIRE(power_mW == expected_mW);
+                received += power_mW > 0;
+            }
+            REQUIRE(received > 0);
+            REQUIRE(received < receivers.size());
+        }
+    }
+}
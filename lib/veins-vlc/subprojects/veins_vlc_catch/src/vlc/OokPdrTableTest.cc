@@ -0,0 +1,149 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "veins-vlc/utility/OokPdrTable.h"
+
+using namespace veins;
+
+namespace {
+
+// Frames from far beyond the sensitivity to the point where the BER underflows, of all lengths in use
+struct TestFrames {
+    std::vector<double> snr;
+    std::vector<int> length;
+
+    explicit TestFrames(size_t count)
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> snr_dB(-20, 35);
+        std::uniform_int_distribution<int> bytes(1, 2000);
+        for (size_t i = 0; i < count; ++i) {
+            snr.push_back(std::pow(10, snr_dB(rng) / 10));
+            length.push_back(8 * bytes(rng));
+        }
+    }
+};
+
+} // namespace
+
+SCENARIO("OokPdrTable interpolates the PDR of OOK within its tolerance", "[ookPdrTable]")
+{
+    GIVEN("Frames of random lengths and SNRs")
+    {
+        TestFrames frames(100000);
+
+        WHEN("Computing their PDRs as a batch")
+        {
+            std::vector<double> pdr(frames.snr.size());
+            getOokPdrs(frames.snr.data(), frames.length.data(), pdr.data(), pdr.size());
+
+            THEN("Each PDR equals the one of the single packet calculation")
+            {
+                for (size_t i = 0; i < pdr.size(); ++i) {
+                    REQUIRE(pdr[i] == getOokPdr(frames.snr[i], frames.length[i]));
+                }
+            }
+        }
+
+        WHEN("Looking them up in tables of different tolerances")
+        {
+            std::vector<double> pdr(frames.snr.size());
+            getOokPdrs(frames.snr.data(), frames.length.data(), pdr.data(), pdr.size());
+
+            THEN("They deviate from the exact PDRs at most by the error bound of the table")
+            {
+                for (double tolerance : {1e-4, 1e-6}) {
+                    auto table = OokPdrTable::get(tolerance);
+                    REQUIRE(table->getErrorBound() <= tolerance);
+                    for (size_t i = 0; i < pdr.size(); ++i) {
+                        REQUIRE(std::fabs(table->getPdr(frames.snr[i], frames.length[i]) - pdr[i]) <= table->getErrorBound());
+                    }
+                }
+            }
+        }
+    }
+
+    GIVEN("A table")
+    {
+        auto table = OokPdrTable::get(1e-6);
+
+        THEN("It is shared by all its users")
+        {
+            REQUIRE(OokPdrTable::get(1e-6) == table);
+        }
+        THEN("It matches getOokPdr() beyond its range")
+        {
+            REQUIRE(table->getPdr(1e200, 124) == 1.0);
+            REQUIRE(table->getPdr(0, 124) == Approx(getOokPdr(0, 124)).margin(1e-6));
+            REQUIRE(std::isnan(table->getPdr(std::nan(""), 124)) == std::isnan(getOokPdr(std::nan(""), 124)));
+        }
+        THEN("It stays within its error bound on a dense grid of SNRs and packet lengths")
+        {
+            // the table interpolates linearly in sqrt(snr), so this grid puts many points between any two entries
+            double maxDeviation = 0;
+            for (int length : {1, 8, 124, 8000, 16000}) {
+                for (double sqrtSnr = 0; sqrtSnr < 100; sqrtSnr += 1e-5) {
+                    const double snr = sqrtSnr * sqrtSnr;
+                    maxDeviation = std::max(maxDeviation, std::fabs(table->getPdr(snr, length) - getOokPdr(snr, length)));
+                }
+            }
+            REQUIRE(maxDeviation <= table->getErrorBound());
+        }
+        THEN("It does not decrease with the SNR")
+        {
+            double previous = 0;
+            for (double snr_dB = -20; snr_dB < 35; snr_dB += 0.001) {
+                const double pdr = table->getPdr(std::pow(10, snr_dB / 10), 8000);
+                REQUIRE(pdr >= previous);
+                previous = pdr;
+            }
+        }
+    }
+}
+
+TEST_CASE("OokPdrTable benchmark", "[.][benchmark]")
+{
+    TestFrames frames(100000);
+    auto table = OokPdrTable::get(1e-6);
+    std::vector<double> pdr(frames.snr.size());
+
+    BENCHMARK("single packets")
+    {
+        for (size_t i = 0; i < pdr.size(); ++i) {
+            pdr[i] = getOokPdr(frames.snr[i], frames.length[i]);
+        }
+    }
+    BENCHMARK("batch")
+    {
+        getOokPdrs(frames.snr.data(), frames.length.data(), pdr.data(), pdr.size());
+    }
+    BENCHMARK("table")
+    {
+        for (size_t i = 0; i < pdr.size(); ++i) {
+            pdr[i] = table->getPdr(frames.snr[i], frames.length[i]);
+        }
+    }
+}
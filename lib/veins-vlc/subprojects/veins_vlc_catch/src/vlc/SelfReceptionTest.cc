@@ -0,0 +1,98 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "testutils/Simulation.h"
+
+using namespace omnetpp;
+
+namespace {
+
+class TestModule : public cModule {
+public:
+    using cModule::insertSubmodule;
+};
+
+// Cars with a headlight and a taillight nic each, laid out like CarVlc: car.nicVlc.phyVlc
+struct TestCars {
+    std::unique_ptr<TestModule> network{new TestModule()};
+    std::vector<cModule*> phys;
+    std::vector<int> hostIds; // what PhyLayerVlc caches per phy
+
+    explicit TestCars(int count)
+    {
+        for (int car = 0; car < count; ++car) {
+            auto host = new TestModule();
+            host->setName(("node" + std::to_string(car)).c_str());
+            network->insertSubmodule(host);
+            for (const char* light : {"nicVlcHead", "nicVlcTail"}) {
+                auto nic = new TestModule();
+                nic->setName(light);
+                host->insertSubmodule(nic);
+                auto phy = new TestModule();
+                phy->setName("phyVlc");
+                nic->insertSubmodule(phy);
+                phys.push_back(phy);
+                hostIds.push_back(car);
+            }
+        }
+    }
+};
+
+} // namespace
+
+TEST_CASE("Self reception check benchmark", "[.][benchmark]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr));
+    TestCars cars(100);
+
+    // sender and receiver phy of each frame, a tenth of them within the same car
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> anyPhy(0, cars.phys.size() - 1);
+    std::vector<std::pair<size_t, size_t>> frames;
+    for (int i = 0; i < 100000; ++i) {
+        const size_t sender = anyPhy(rng);
+        frames.emplace_back(sender, i % 10 == 0 ? sender ^ 1 : anyPhy(rng));
+    }
+
+    long byName = 0;
+    long byHostId = 0;
+    BENCHMARK("host full names")
+    {
+        byName = 0;
+        for (const auto& frame : frames) {
+            std::string txNode = cars.phys[frame.first]->getModuleByPath("^.^.")->getFullName();
+            byName += txNode == cars.phys[frame.second]->getModuleByPath("^.^.")->getFullName();
+        }
+    }
+    BENCHMARK("host ids")
+    {
+        byHostId = 0;
+        for (const auto& frame : frames) {
+            byHostId += cars.hostIds[frame.first] == cars.hostIds[frame.second];
+        }
+    }
+    REQUIRE(byName == byHostId);
+}
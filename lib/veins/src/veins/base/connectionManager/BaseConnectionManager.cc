@@ -70,7 +70,7 @@ void BaseConnectionManager::initialize(int stage)
 
         EV_TRACE << "initializing BaseConnectionManager\n";
 
-        BaseWorldUtility* world = FindModule<BaseWorldUtility*>::findGlobalModule();
+        BaseWorldUtility* world = FindModule<BaseWorldUtility*>::findGlobalModule(this);
 
         ASSERT(world != nullptr);
 
@@ -296,22 +296,25 @@ void BaseConnectionManager::updateNicConnections(NicEntries& nmap, BaseConnectio
         if (nic_i->nicId == id) continue;
 
         bool inRange = isInRange(nic, nic_i);
-        bool connected = nic->isConnected(nic_i);
-
-        if (inRange && !connected) {
-            // nodes within communication range: connect
-            // nodes within communication range && not yet connected
-            EV_TRACE << "nic #" << id << " and #" << nic_i->nicId << " are in range" << endl;
-            nic->connectTo(nic_i);
-            nic_i->connectTo(nic);
-        }
-        else if (!inRange && connected) {
-            // out of range: disconnect
-            // out of range, and still connected
-            EV_TRACE << "nic #" << id << " and #" << nic_i->nicId << " are NOT in range" << endl;
-            nic->disconnectFrom(nic_i);
-            nic_i->disconnectFrom(nic);
-        }
+        bool inRangeBack = directionalRange ? isInRange(nic_i, nic) : inRange;
+        updateNicConnection(nic, nic_i, inRange);
+        updateNicConnection(nic_i, nic, inRangeBack);
+    }
+}
+
+void BaseConnectionManager::updateNicConnection(BaseConnectionManager::NicEntries::mapped_type fromNic, BaseConnectionManager::NicEntries::mapped_type toNic, bool inRange)
+{
+    bool connected = fromNic->isConnected(toNic);
+
+    if (inRange && !connected) {
+        // nodes within communication range && not yet connected
+        EV_TRACE << "nic #" << fromNic->nicId << " reaches #" << toNic->nicId << endl;
+        fromNic->connectTo(toNic);
+    }
+    else if (!inRange && connected) {
+        // out of range, and still connected
+        EV_TRACE << "nic #" << fromNic->nicId << " does NOT reach #" << toNic->nicId << endl;
+        fromNic->disconnectFrom(toNic);
     }
 }
 
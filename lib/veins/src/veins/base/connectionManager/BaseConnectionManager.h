@@ -270,6 +270,9 @@ protected:
      * TkEnv.*/
     bool drawMIR;
 
+    /** @brief Whether isInRange() may differ between both directions of a pair of nics.*/
+    bool directionalRange = false;
+
     /** @brief Type for 1-dimensional array of NicEntries.*/
     using RowVector = std::vector<NicEntries>;
     /** @brief Type for 2-dimensional array of NicEntries.*/
@@ -302,6 +305,11 @@ private:
     /** @brief Manages the connections of a registered nic. */
     void updateNicConnections(NicEntries& nmap, NicEntries::mapped_type nic);
 
+    /**
+     * @brief Connects or disconnects one direction of a pair of nics
+     */
+    void updateNicConnection(NicEntries::mapped_type fromNic, NicEntries::mapped_type toNic, bool inRange);
+
     /**
      * @brief Check connections of a nic in the grid
      */
@@ -39,7 +39,9 @@ BaseConnectionManager* ChannelAccess::getConnectionManager(cModule* nic)
 {
     std::string cmName = nic->hasPar("connectionManagerName") ? nic->par("connectionManagerName").stringValue() : "";
     if (cmName != "") {
-        cModule* ccModule = veins::findModuleByPath(cmName.c_str());
+        // relative to the scenario of the nic, unless it is the whole network
+        cModule* const scenario = FindModule<>::findScenario(nic);
+        cModule* ccModule = scenario == getSimulation()->getSystemModule() ? veins::findModuleByPath(cmName.c_str()) : scenario->getSubmodule(cmName.c_str());
 
         return dynamic_cast<BaseConnectionManager*>(ccModule);
     }
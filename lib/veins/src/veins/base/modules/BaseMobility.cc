@@ -82,7 +82,7 @@ void BaseMobility::initialize(int stage)
         hasPar("scaleNodeByDepth") ? scaleNodeByDepth = par("scaleNodeByDepth").boolValue() : scaleNodeByDepth = true;
 
         // get utility pointers (world and host)
-        world = FindModule<BaseWorldUtility*>::findGlobalModule();
+        world = FindModule<BaseWorldUtility*>::findGlobalModule(this);
         if (world == nullptr) throw cRuntimeError("Could not find BaseWorldUtility module");
 
         EV_TRACE << "initializing BaseUtility stage " << stage << endl; // for node position
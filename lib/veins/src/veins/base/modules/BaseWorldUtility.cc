@@ -45,7 +45,7 @@ void BaseWorldUtility::initialize(int stage)
     else if (stage == 1) {
         // check if necessary modules are there
         // Connection Manager
-        if (!FindModule<BaseConnectionManager*>::findGlobalModule()) {
+        if (!FindModule<BaseConnectionManager*>::findGlobalModule(this)) {
             throw cRuntimeError("Could not find a connection manager module in the network!");
         }
     }
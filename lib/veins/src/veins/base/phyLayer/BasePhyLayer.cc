@@ -93,7 +93,7 @@ void BasePhyLayer::initialize(int stage)
 
         radio = initializeRadio();
 
-        world = FindModule<BaseWorldUtility*>::findGlobalModule();
+        world = FindModule<BaseWorldUtility*>::findGlobalModule(this);
         if (world == nullptr) {
             throw cRuntimeError("Could not find BaseWorldUtility module");
         }
@@ -88,19 +88,49 @@ public:
         return findSubModule(getSimulation()->getSystemModule());
     }
 
+    /**
+     * @brief Returns a pointer to the module with the type of this
+     * template in the scenario of the passed module, see findScenario().
+     *
+     * Same as findGlobalModule() if the passed module is NULL.
+     * Returns NULL if no module of this type could be found.
+     */
+    static T findGlobalModule(const cModule* const from)
+    {
+        return findSubModule(findScenario(from));
+    }
+
+    /**
+     * @brief Returns the module whose sub modules form the scenario of
+     * the passed module.
+     *
+     * That is the closest ancestor with a \@scenario property, or the
+     * simulation's system module if there is none. Several scenarios can
+     * thus share one network without seeing each other's modules.
+     */
+    static cModule* findScenario(const cModule* const m)
+    {
+        cModule* const system = getSimulation()->getSystemModule();
+        for (cModule* parent = m != nullptr ? m->getParentModule() : nullptr; parent != nullptr && parent != system; parent = parent->getParentModule()) {
+            if (parent->getProperties()->getAsBool("scenario")) return parent;
+        }
+        return system;
+    }
+
     /**
      * @brief Returns a pointer to the host module of the passed module.
      *
-     * Assumes that every host module is a direct sub module of the
-     * simulation.
+     * Assumes that every host module is a direct sub module of its
+     * scenario, see findScenario().
      */
     static cModule* const findHost(cModule* const m)
     {
+        const cModule* const scenario = findScenario(m);
         cModule* parent = m != nullptr ? m->getParentModule() : nullptr;
         cModule* node = m;
 
-        // all nodes should be a sub module of the simulation which has no parent module!!!
-        while (parent != nullptr && parent->getParentModule() != nullptr) {
+        // all nodes should be a sub module of the scenario, usually the simulation which has no parent module!!!
+        while (parent != nullptr && parent != scenario && parent->getParentModule() != nullptr) {
             node = parent;
             parent = node->getParentModule();
         }
@@ -109,11 +139,12 @@ public:
     // the constness version
     static const cModule* const findHost(const cModule* const m)
     {
+        const cModule* const scenario = findScenario(m);
         const cModule* parent = m != nullptr ? m->getParentModule() : nullptr;
         const cModule* node = m;
 
-        // all nodes should be a sub module of the simulation which has no parent module!!!
-        while (parent != nullptr && parent->getParentModule() != nullptr) {
+        // all nodes should be a sub module of the scenario, usually the simulation which has no parent module!!!
+        while (parent != nullptr && parent != scenario && parent->getParentModule() != nullptr) {
             node = parent;
             parent = node->getParentModule();
         }
@@ -42,7 +42,7 @@ void DemoBaseApplLayer::initialize(int stage)
             traciVehicle = nullptr;
         }
 
-        annotations = AnnotationManagerAccess().getIfExists();
+        annotations = AnnotationManagerAccess().getIfExists(this);
         ASSERT(annotations);
 
         mac = FindModule<DemoBaseApplLayerToMac1609_4Interface*>::findSubModule(getParentModule());
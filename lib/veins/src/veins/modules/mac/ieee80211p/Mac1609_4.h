@@ -160,6 +160,14 @@ public:
 
     void changeServiceChannel(Channel channelNumber) override;
 
+    /**
+     * @brief Return the time the channel has been sensed busy so far, including a busy period that is still ongoing
+     */
+    simtime_t getTotalBusyTime() const
+    {
+        return statsTotalBusyTime + (idleChannel ? SIMTIME_ZERO : simTime() - lastBusy);
+    }
+
     /**
      * @brief Change the default tx power the NIC card is using
      *
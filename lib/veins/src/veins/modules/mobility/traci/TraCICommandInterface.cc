@@ -1300,6 +1300,28 @@ std::pair<double, double> TraCICommandInterface::getLonLat(const Coord& coord)
     return std::make_pair(convPosLon, convPosLat);
 }
 
+simtime_t TraCICommandInterface::getCurrentTime()
+{
+    return genericGetTime(CMD_GET_SIM_VARIABLE, "", getTimeStepCmd(), RESPONSE_GET_SIM_VARIABLE);
+}
+
+std::list<std::string> TraCICommandInterface::getVehicleIds()
+{
+    return genericGetStringList(CMD_GET_VEHICLE_VARIABLE, "", ID_LIST, RESPONSE_GET_VEHICLE_VARIABLE);
+}
+
+void TraCICommandInterface::saveState(std::string fileName)
+{
+    TraCIBuffer buf = connection.query(CMD_SET_SIM_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(CMD_SAVE_SIMSTATE) << std::string("") << static_cast<uint8_t>(TYPE_STRING) << fileName);
+    ASSERT(buf.eof());
+}
+
+void TraCICommandInterface::loadState(std::string fileName)
+{
+    TraCIBuffer buf = connection.query(CMD_SET_SIM_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(CMD_LOAD_SIMSTATE) << std::string("") << static_cast<uint8_t>(TYPE_STRING) << fileName);
+    ASSERT(buf.eof());
+}
+
 std::tuple<std::string, double, uint8_t> TraCICommandInterface::getRoadMapPos(const Coord& coord)
 {
     TraCIBuffer request;
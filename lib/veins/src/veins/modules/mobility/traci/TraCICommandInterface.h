@@ -71,6 +71,10 @@ public:
     std::pair<uint32_t, std::string> getVersion();
     void setApiVersion(uint32_t apiVersion);
     std::pair<double, double> getLonLat(const Coord&);
+    simtime_t getCurrentTime();
+    std::list<std::string> getVehicleIds();
+    void saveState(std::string fileName);
+    void loadState(std::string fileName);
 
     unsigned getApiVersion() const
     {
@@ -140,7 +140,7 @@ public:
     }
     virtual TraCIScenarioManager* getManager() const
     {
-        if (!manager) manager = TraCIScenarioManagerAccess().get();
+        if (!manager) manager = TraCIScenarioManagerAccess().get(this);
         return manager;
     }
     virtual TraCICommandInterface* getCommandInterface() const
@@ -51,6 +51,7 @@ const simsignal_t TraCIScenarioManager::traciModuleAddedSignal = registerSignal(
 const simsignal_t TraCIScenarioManager::traciModuleRemovedSignal = registerSignal("org_car2x_veins_modules_mobility_traciModuleRemoved");
 const simsignal_t TraCIScenarioManager::traciTimestepBeginSignal = registerSignal("org_car2x_veins_modules_mobility_traciTimestepBegin");
 const simsignal_t TraCIScenarioManager::traciTimestepEndSignal = registerSignal("org_car2x_veins_modules_mobility_traciTimestepEnd");
+const simsignal_t TraCIScenarioManager::traciStateLoadedSignal = registerSignal("org_car2x_veins_modules_mobility_traciStateLoaded");
 
 TraCIScenarioManager::TraCIScenarioManager()
     : connection(nullptr)
@@ -264,7 +265,7 @@ void TraCIScenarioManager::initialize(int stage)
     }
     autoShutdown = par("autoShutdown");
 
-    annotations = AnnotationManagerAccess().getIfExists();
+    annotations = AnnotationManagerAccess().getIfExists(this);
 
     roi.clear();
     roi.addRoads(par("roiRoads"));
@@ -279,10 +280,11 @@ void TraCIScenarioManager::initialize(int stage)
     parkingVehicleCount = 0;
     drivingVehicleCount = 0;
     autoShutdownTriggered = false;
+    traciTimeOffset = 0;
 
-    world = FindModule<BaseWorldUtility*>::findGlobalModule();
+    world = FindModule<BaseWorldUtility*>::findGlobalModule(this);
 
-    vehicleObstacleControl = FindModule<VehicleObstacleControl*>::findGlobalModule();
+    vehicleObstacleControl = FindModule<VehicleObstacleControl*>::findGlobalModule(this);
 
     ASSERT(firstStepAt > connectAt);
     connectAndStartTrigger = new cMessage("connect");
@@ -624,8 +626,13 @@ void TraCIScenarioManager::executeOneTimestep()
 
     emit(traciTimestepBeginSignal, targetTime);
 
-    if (isConnected()) {
-        TraCIBuffer buf = connection->query(CMD_SIMSTEP2, TraCIBuffer() << targetTime);
+    if (isConnected() && !pendingStateFile.empty()) {
+        std::string fileName = pendingStateFile;
+        pendingStateFile.clear();
+        loadState(fileName);
+    }
+    else if (isConnected()) {
+        TraCIBuffer buf = connection->query(CMD_SIMSTEP2, TraCIBuffer() << (targetTime - traciTimeOffset));
 
         uint32_t count;
         buf >> count;
@@ -637,7 +644,40 @@ void TraCIScenarioManager::executeOneTimestep()
 
     emit(traciTimestepEndSignal, targetTime);
 
-    if (!autoShutdownTriggered) scheduleAt(simTime() + updateInterval, executeOneTimestepTrigger);
+    // a pending state load revives the simulation even if all vehicles have just arrived
+    if (!autoShutdownTriggered || !pendingStateFile.empty()) scheduleAt(simTime() + updateInterval, executeOneTimestepTrigger);
+}
+
+void TraCIScenarioManager::loadState(std::string fileName)
+{
+    EV_DEBUG << "Loading TraCI server state from " << fileName << endl;
+
+    // take down all modules of the current state
+    std::list<std::string> nodeIds;
+    for (auto& host : hosts) nodeIds.push_back(host.first);
+    for (auto& nodeId : nodeIds) deleteManagedModule(nodeId);
+    for (auto& vehicleId : subscribedVehicles) unsubscribeFromVehicleVariables(vehicleId);
+    subscribedVehicles.clear();
+    unEquippedHosts.clear();
+
+    commandIfc->loadState(fileName);
+    traciTimeOffset = simTime() - commandIfc->getCurrentTime();
+    EV_DEBUG << "TraCI server time is now offset by " << traciTimeOffset << " s." << endl;
+
+    // note that vehicles parking in the restored state are counted as driving
+    std::list<std::string> vehicleIds = commandIfc->getVehicleIds();
+    activeVehicleCount = vehicleIds.size();
+    parkingVehicleCount = 0;
+    drivingVehicleCount = activeVehicleCount;
+    autoShutdownTriggered = false;
+
+    // subscribing immediately re-creates the modules from the restored positions
+    for (auto& vehicleId : vehicleIds) {
+        subscribedVehicles.insert(vehicleId);
+        subscribeToVehicleVariables(vehicleId);
+    }
+
+    emit(traciStateLoadedSignal, true);
 }
 
 void TraCIScenarioManager::subscribeToVehicleVariables(std::string vehicleId)
@@ -743,7 +783,7 @@ void TraCIScenarioManager::processTrafficLightSubscription(std::string objectId,
             break;
 
         case TL_NEXT_SWITCH:
-            tlIfModule->setNextSwitch(buf.readTypeChecked<simtime_t>(getCommandInterface()->getTimeType()), false);
+            tlIfModule->setNextSwitch(buf.readTypeChecked<simtime_t>(getCommandInterface()->getTimeType()) + traciTimeOffset, false);
             break;
 
         case TL_RED_YELLOW_GREEN_STATE:
@@ -909,7 +949,7 @@ void TraCIScenarioManager::processSimSubscription(std::string objectId, TraCIBuf
             buf >> serverTimestep;
             EV_DEBUG << "TraCI reports current time step as " << serverTimestep << " s." << endl;
             simtime_t omnetTimestep = simTime();
-            ASSERT(omnetTimestep == serverTimestep);
+            ASSERT(omnetTimestep == serverTimestep + traciTimeOffset);
         }
         else if (variable1_resp == VAR_COLLIDING_VEHICLES_IDS) {
             uint8_t varType;
@@ -72,6 +72,7 @@ public:
     static const simsignal_t traciModuleRemovedSignal;
     static const simsignal_t traciTimestepBeginSignal;
     static const simsignal_t traciTimestepEndSignal;
+    static const simsignal_t traciStateLoadedSignal;
 
     TraCIScenarioManager();
     ~TraCIScenarioManager() override;
@@ -110,6 +111,18 @@ public:
         return hosts;
     }
 
+    /**
+     * Restore a state of the TraCI server that was previously written using TraCICommandInterface::saveState.
+     *
+     * The state is loaded at the start of the next timestep instead of advancing the TraCI server.
+     * All managed modules are deleted and re-created for the vehicles of the restored state, OMNeT++ time keeps running forward.
+     * Emits traciStateLoadedSignal once done.
+     */
+    void loadStateAtNextTimestep(std::string fileName)
+    {
+        pendingStateFile = fileName;
+    }
+
     /**
      * Predicate indicating a successful connection to the TraCI server.
      *
@@ -125,6 +138,8 @@ protected:
     simtime_t connectAt; /**< when to connect to TraCI server (must be the initial timestep of the server) */
     simtime_t firstStepAt; /**< when to start synchronizing with the TraCI server (-1: immediately after connecting) */
     simtime_t updateInterval; /**< time interval of hosts' position updates */
+    simtime_t traciTimeOffset; /**< OMNeT++ time minus TraCI server time, changes whenever a state is loaded */
+    std::string pendingStateFile; /**< state to load at the next timestep (empty: none) */
     // maps from vehicle type to moduleType, moduleName, and moduleDisplayString
     typedef std::map<std::string, std::string> TypeMapping;
     TypeMapping moduleType; /**< module type to be used in the simulation for each managed vehicle */
@@ -165,6 +180,7 @@ protected:
     VehicleObstacleControl* vehicleObstacleControl;
 
     void executeOneTimestep(); /**< read and execute all commands for the next timestep */
+    void loadState(std::string fileName); /**< replace all managed vehicles by those of a saved TraCI server state */
 
     virtual void init_traci();
 
@@ -205,9 +221,10 @@ protected:
 
 class VEINS_API TraCIScenarioManagerAccess {
 public:
-    TraCIScenarioManager* get()
+    // from: module whose scenario to search, see FindModule::findScenario() (nullptr: the whole network)
+    TraCIScenarioManager* get(const cModule* from = nullptr)
     {
-        return FindModule<TraCIScenarioManager*>::findGlobalModule();
+        return FindModule<TraCIScenarioManager*>::findGlobalModule(from);
     };
 };
 
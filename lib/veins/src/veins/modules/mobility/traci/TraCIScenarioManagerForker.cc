@@ -28,11 +28,14 @@
 #include <netinet/tcp.h>
 #include <netdb.h>
 #include <arpa/inet.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #endif
 
 #include <sstream>
 #include <iostream>
 #include <fstream>
+#include <cstdio>
 
 #include "veins/modules/mobility/traci/TraCIScenarioManagerForker.h"
 #include "veins/modules/mobility/traci/TraCICommandInterface.h"
@@ -62,6 +65,8 @@ inline std::string replace(std::string haystack, std::string needle, T newValue)
 TraCIScenarioManagerForker::TraCIScenarioManagerForker()
 {
     server = nullptr;
+    workers = 1;
+    workerIndex = 0;
 }
 
 TraCIScenarioManagerForker::~TraCIScenarioManagerForker()
@@ -76,10 +81,12 @@ void TraCIScenarioManagerForker::initialize(int stage)
         command = par("command").stringValue();
         configFile = par("configFile").stringValue();
         seed = par("seed");
+        workers = par("workers");
         killServer();
     }
     TraCIScenarioManager::initialize(stage);
     if (stage == 1) {
+        forkWorkers();
         startServer();
     }
 }
@@ -88,6 +95,63 @@ void TraCIScenarioManagerForker::finish()
 {
     TraCIScenarioManager::finish();
     killServer();
+    waitForWorkers();
+}
+
+void TraCIScenarioManagerForker::forkWorkers()
+{
+    if (workers <= 1) return;
+
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32) || defined(__CYGWIN__) || defined(_WIN64)
+    throw cRuntimeError("Forking workers is not supported on this platform");
+#else
+    // do not let every worker repeat output that is still buffered
+    std::cout.flush();
+    fflush(nullptr);
+
+    for (int i = 1; i < workers; ++i) {
+        pid_t pid = fork();
+        if (pid == -1) {
+            throw cRuntimeError("Could not fork worker %d: %s", i, strerror(errno));
+        }
+        if (pid == 0) {
+            workerIndex = i;
+            workerPids.clear();
+            break;
+        }
+        workerPids.push_back(pid);
+    }
+    EV_INFO << "Running as worker " << workerIndex << " of " << workers << endl;
+
+    // give each worker its own TraCI server port
+    if (workerIndex > 0) {
+        if (par("port").intValue() == -1 && std::getenv("VEINS_TRACI_PORT") == nullptr) {
+            port = getPortNumber();
+        }
+        else {
+            port += workerIndex;
+        }
+    }
+
+    // and its own random number streams, distinct from all workers of runs with other seed sets
+    cEnvir* envir = getEnvir();
+    int seedSet = atoi(envir->getConfigEx()->getVariable(CFGVAR_SEEDSET)) * workers + workerIndex;
+    for (int k = 0; k < envir->getNumRNGs(); ++k) {
+        envir->getRNG(k)->initialize(seedSet, k, envir->getNumRNGs(), 0, 1, envir->getConfig());
+    }
+#endif
+}
+
+void TraCIScenarioManagerForker::waitForWorkers()
+{
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32) || defined(__CYGWIN__) || defined(_WIN64)
+#else
+    for (auto pid : workerPids) {
+        int status;
+        waitpid(pid, &status, 0);
+    }
+#endif
+    workerPids.clear();
 }
 
 void TraCIScenarioManagerForker::startServer()
@@ -97,6 +161,7 @@ void TraCIScenarioManagerForker::startServer()
         const char* seed_s = cSimulation::getActiveSimulation()->getEnvir()->getConfigEx()->getVariable(CFGVAR_RUNNUMBER);
         seed = atoi(seed_s);
     }
+    seed = seed * workers + workerIndex;
 
     // assemble commandLine
     commandLine = replace(commandLine, "$command", command);
@@ -34,6 +34,9 @@ namespace veins {
  *
  * Extends the TraCIScenarioManager to automatically fork an instance of SUMO when needed.
  *
+ * If more than one worker is requested, the simulation is forked once the network has been set up, just before SUMO is launched.
+ * Each worker then launches its own SUMO instance with a distinct seed and port and re-seeds its random number generators.
+ *
  * All other functionality is provided by the TraCIScenarioManager.
  *
  * See the Veins website <a href="http://veins.car2x.org/"> for a tutorial, documentation, and publications </a>.
@@ -51,14 +54,24 @@ public:
     void initialize(int stage) override;
     void finish() override;
 
+    int getWorkerIndex() const
+    {
+        return workerIndex;
+    }
+
 protected:
     std::string commandLine; /**< command line for running TraCI server (substituting $configFile, $seed, $port) */
     std::string command; /**< substitution for $command parameter */
     std::string configFile; /**< substitution for $configFile parameter */
     int seed; /**< substitution for $seed parameter (-1: current run number) */
+    int workers; /**< number of processes running copies of the simulation (1: do not fork) */
+    int workerIndex; /**< index of this process among the workers (0: the process that forked the others) */
+    std::vector<int> workerPids; /**< process ids of forked workers, only known to worker 0 */
 
     TraCILauncher* server;
 
+    virtual void forkWorkers();
+    virtual void waitForWorkers();
     virtual void startServer();
     virtual void killServer();
     int getPortNumber() const override;
@@ -66,9 +79,10 @@ protected:
 
 class VEINS_API TraCIScenarioManagerForkerAccess {
 public:
-    TraCIScenarioManagerForker* get()
+    // from: module whose scenario to search, see FindModule::findScenario() (nullptr: the whole network)
+    TraCIScenarioManagerForker* get(const cModule* from = nullptr)
     {
-        return FindModule<TraCIScenarioManagerForker*>::findGlobalModule();
+        return FindModule<TraCIScenarioManagerForker*>::findGlobalModule(from);
     };
 };
 } // namespace veins
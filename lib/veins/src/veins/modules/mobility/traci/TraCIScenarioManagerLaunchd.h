@@ -60,9 +60,10 @@ protected:
 
 class VEINS_API TraCIScenarioManagerLaunchdAccess {
 public:
-    TraCIScenarioManagerLaunchd* get()
+    // from: module whose scenario to search, see FindModule::findScenario() (nullptr: the whole network)
+    TraCIScenarioManagerLaunchd* get(const cModule* from = nullptr)
     {
-        return FindModule<TraCIScenarioManagerLaunchd*>::findGlobalModule();
+        return FindModule<TraCIScenarioManagerLaunchd*>::findGlobalModule(from);
     };
 };
 
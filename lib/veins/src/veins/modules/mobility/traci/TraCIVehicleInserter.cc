@@ -57,7 +57,7 @@ void TraCIVehicleInserter::initialize(int stage)
     }
 
     // internal 1
-    manager = TraCIScenarioManagerAccess().get();
+    manager = TraCIScenarioManagerAccess().get(this);
 
     // signals
     manager->subscribe(TraCIScenarioManager::traciModuleAddedSignal, this);
@@ -38,7 +38,7 @@ veins::BBoxLookup rebuildBBoxLookup(const std::vector<std::unique_ptr<veins::Obs
     std::vector<veins::Obstacle*> obstaclePointers;
     obstaclePointers.reserve(obstacleOwner.size());
     std::transform(obstacleOwner.begin(), obstacleOwner.end(), std::back_inserter(obstaclePointers), [](const std::unique_ptr<veins::Obstacle>& obstacle) { return obstacle.get(); });
-    auto playgroundSize = veins::FindModule<veins::BaseWorldUtility*>::findGlobalModule()->getPgs();
+    auto playgroundSize = veins::FindModule<veins::BaseWorldUtility*>::findGlobalModule(this)->getPgs();
     auto bboxFunction = [](veins::Obstacle* o) { return veins::BBoxLookup::Box{{o->getBboxP1().x, o->getBboxP1().y}, {o->getBboxP2().x, o->getBboxP2().y}}; };
     return veins::BBoxLookup(obstaclePointers, bboxFunction, playgroundSize->x, playgroundSize->y, gridCellSize);
 }
@@ -56,7 +56,7 @@ void ObstacleControl::initialize(int stage)
         cacheEntries.clear();
         isBboxLookupDirty = true;
 
-        annotations = AnnotationManagerAccess().getIfExists();
+        annotations = AnnotationManagerAccess().getIfExists(this);
         if (annotations) annotationGroup = annotations->createGroup("obstacles");
 
         obstaclesXml = par("obstacles");
@@ -43,7 +43,7 @@ VehicleObstacleControl::~VehicleObstacleControl() = default;
 void VehicleObstacleControl::initialize(int stage)
 {
     if (stage == 1) {
-        annotations = AnnotationManagerAccess().getIfExists();
+        annotations = AnnotationManagerAccess().getIfExists(this);
         if (annotations) {
             vehicleAnnotationGroup = annotations->createGroup("vehicleObstacles");
         }
@@ -47,7 +47,7 @@ simtime_t Decider80211p::processNewSignal(AirFrame* msg)
     // get the receiving power of the Signal at start-time and center frequency
     Signal& signal = frame->getSignal();
 
-    signalStates[frame] = EXPECT_END;
+    frame->setSignalState(EXPECT_END);
 
     if (signal.smallerAtCenterFrequency(minPowerLevel)) {
 
@@ -95,13 +95,7 @@ simtime_t Decider80211p::processNewSignal(AirFrame* msg)
 
 int Decider80211p::getSignalState(AirFrame* frame)
 {
-
-    if (signalStates.find(frame) == signalStates.end()) {
-        return NEW;
-    }
-    else {
-        return signalStates[frame];
-    }
+    return check_and_cast<AirFrame11p*>(frame)->getSignalState();
 }
 
 DeciderResult* Decider80211p::checkIfSignalOk(AirFrame* frame)
@@ -282,7 +276,7 @@ simtime_t Decider80211p::processSignalEnd(AirFrame* msg)
     bool whileSending = false;
 
     // remove this frame from our current signals
-    signalStates.erase(frame);
+    frame->setSignalState(NEW);
 
     DeciderResult* result;
 
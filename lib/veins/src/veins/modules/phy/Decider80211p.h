@@ -106,7 +106,6 @@ protected:
 
     std::string myPath;
     Decider80211pToPhy80211pInterface* phy11p;
-    std::map<AirFrame*, int> signalStates;
 
     /** @brief enable/disable statistics collection for collisions
      *
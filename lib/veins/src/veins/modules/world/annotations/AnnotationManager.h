@@ -176,9 +176,10 @@ protected:
 
 class VEINS_API AnnotationManagerAccess {
 public:
-    AnnotationManager* getIfExists()
+    // from: module whose scenario to search, see FindModule::findScenario() (nullptr: the whole network)
+    AnnotationManager* getIfExists(const cModule* from = nullptr)
     {
-        return FindModule<AnnotationManager*>::findGlobalModule();
+        return FindModule<AnnotationManager*>::findGlobalModule(from);
     };
 };
 
@@ -50,7 +50,7 @@ public:
     virtual TraCIScenarioManager* getManager() const
     {
         if (!manager) {
-            manager = TraCIScenarioManagerAccess().get();
+            manager = TraCIScenarioManagerAccess().get(this);
         }
         return manager;
     }
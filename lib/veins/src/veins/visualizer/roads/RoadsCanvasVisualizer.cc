@@ -37,7 +37,7 @@ void RoadsCanvasVisualizer::initialize(int stage)
 
     if (stage == 0) {
 
-        TraCIScenarioManager* manager = TraCIScenarioManagerAccess().get();
+        TraCIScenarioManager* manager = TraCIScenarioManagerAccess().get(this);
         ASSERT(manager);
 
         figures = new cGroupFigure("roads");
@@ -51,7 +51,7 @@ void RoadsOsgVisualizer::initialize(int stage)
 
     if (stage == 0) {
 
-        TraCIScenarioManager* manager = TraCIScenarioManagerAccess().get();
+        TraCIScenarioManager* manager = TraCIScenarioManagerAccess().get(this);
         ASSERT(manager);
 
         figures = new osg::Group();
@@ -0,0 +1,95 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "serpentine/DeliveryTracker.h"
+
+#include <algorithm>
+
+const DeliveryTracker::Reception* DeliveryTracker::Delivery::firstReception(const std::string& receiverId) const
+{
+    for (const auto& reception : receptions) {
+        if (reception.receiverId == receiverId) {
+            return &reception;
+        }
+    }
+    return nullptr;
+}
+
+bool DeliveryTracker::Delivery::receivedVia(const std::string& receiverId, Interface interface) const
+{
+    for (const auto& reception : receptions) {
+        if (reception.interface == interface && reception.receiverId == receiverId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DeliveryTracker::sent(long treeId, Interfaces interfaces)
+{
+    auto& delivery = deliveries[treeId];
+    delivery.sendTime = omnetpp::simTime();
+    delivery.interfaces = interfaces;
+    delivery.receptions.clear();
+}
+
+void DeliveryTracker::received(long treeId, const std::string& receiverId, Interface interface)
+{
+    const auto delivery = deliveries.find(treeId);
+    if (delivery == deliveries.end()) {
+        return;
+    }
+    delivery->second.receptions.push_back({receiverId, interface, omnetpp::simTime() - delivery->second.sendTime});
+}
+
+int DeliveryTracker::settle(std::vector<long>& treeIds, const std::string& receiverId, omnetpp::simtime_t timeout)
+{
+    int received = 0;
+    const auto settled = [&](long treeId) {
+        const auto delivery = deliveries.find(treeId);
+        if (delivery == deliveries.end()) {
+            return true;
+        }
+        const bool arrived = delivery->second.firstReception(receiverId) != nullptr;
+        if (!arrived && omnetpp::simTime() - delivery->second.sendTime < timeout) {
+            return false;
+        }
+        received += arrived;
+        deliveries.erase(delivery);
+        return true;
+    };
+    treeIds.erase(std::remove_if(treeIds.begin(), treeIds.end(), settled), treeIds.end());
+    return received;
+}
+
+void DeliveryTracker::shift(omnetpp::simtime_t offset)
+{
+    for (auto& delivery : deliveries) {
+        delivery.second.sendTime += offset;
+    }
+}
+
+const DeliveryTracker::Delivery* DeliveryTracker::find(long treeId) const
+{
+    const auto delivery = deliveries.find(treeId);
+    return delivery == deliveries.end() ? nullptr : &delivery->second;
+}
@@ -0,0 +1,86 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <omnetpp.h>
+#include "veins-vlc/Splitter.h"
+
+/**
+ * Which vehicles received a packet via which interface, and how long it took, keyed by the tree id of the packet.
+ *
+ * Only packets announced via sent() are tracked, receptions of other packets are ignored.
+ * All copies of a packet (one per interface) share its tree id, so a record covers all interfaces the sender chose.
+ * Records live until the sender settles them, once the packet arrived or could no longer be expected to.
+ */
+class DeliveryTracker {
+public:
+    using Interface = veins::Splitter::Interface;
+    using Interfaces = veins::Splitter::Interfaces;
+
+    struct Reception {
+        std::string receiverId;
+        Interface interface;
+        omnetpp::simtime_t latency;
+    };
+
+    struct Delivery {
+        omnetpp::simtime_t sendTime;
+        Interfaces interfaces; // chosen by the sender
+        std::vector<Reception> receptions; // in order of arrival
+
+        const Reception* firstReception(const std::string& receiverId) const; // nullptr if not received (yet)
+        bool receivedVia(const std::string& receiverId, Interface interface) const;
+    };
+
+    void sent(long treeId, Interfaces interfaces);
+    void received(long treeId, const std::string& receiverId, Interface interface);
+    const Delivery* find(long treeId) const; // nullptr if not tracked
+
+    /**
+     * Settles the packets of treeIds that receiverId got, or that were sent at least timeout ago.
+     *
+     * Settled packets are forgotten and removed from treeIds, as are packets no longer tracked.
+     * Returns how many of the settled packets receiverId got.
+     */
+    int settle(std::vector<long>& treeIds, const std::string& receiverId, omnetpp::simtime_t timeout);
+    void forget(long treeId)
+    {
+        deliveries.erase(treeId);
+    }
+    void clear()
+    {
+        deliveries.clear();
+    }
+    void shift(omnetpp::simtime_t offset); // moves all send times by offset, to keep their ages when carried over to another point in time
+    size_t size() const
+    {
+        return deliveries.size();
+    }
+
+private:
+    std::unordered_map<long, Delivery> deliveries;
+};
@@ -0,0 +1,279 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "serpentine/EmbeddedPolicy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include <omnetpp.h>
+
+namespace {
+
+// reads whitespace separated tokens, skipping comments
+class TokenReader {
+public:
+    TokenReader(const std::string& fileName)
+        : fileName(fileName)
+    {
+        std::ifstream file(fileName);
+        if (!file) {
+            throw omnetpp::cRuntimeError("Could not open policy file '%s'", fileName.c_str());
+        }
+        std::string line;
+        while (std::getline(file, line)) {
+            contents << line.substr(0, line.find('#')) << '\n';
+        }
+    }
+
+    bool next(std::string& token)
+    {
+        return static_cast<bool>(contents >> token);
+    }
+
+    std::string word()
+    {
+        std::string token;
+        if (!next(token)) {
+            throw omnetpp::cRuntimeError("Unexpected end of policy file '%s'", fileName.c_str());
+        }
+        return token;
+    }
+
+    template <typename T>
+    T number()
+    {
+        T value;
+        if (!(contents >> value)) {
+            throw omnetpp::cRuntimeError("Expected a number in policy file '%s'", fileName.c_str());
+        }
+        return value;
+    }
+
+private:
+    std::string fileName;
+    std::stringstream contents;
+};
+
+} // namespace
+
+EmbeddedPolicy::EmbeddedPolicy(const std::string& fileName)
+{
+    TokenReader reader(fileName);
+    if (reader.word() != "serpentine-policy" || reader.number<int>() != 1) {
+        throw omnetpp::cRuntimeError("'%s' is not a version 1 serpentine policy file", fileName.c_str());
+    }
+
+    std::string section;
+    while (reader.next(section)) {
+        if (section == "output") {
+            const auto kind = reader.word();
+            if (kind != "discrete" && kind != "box") {
+                throw omnetpp::cRuntimeError("Unknown policy output '%s'", kind.c_str());
+            }
+            discreteOutput = kind == "discrete";
+        }
+        else if (section == "layer") {
+            Layer layer;
+            layer.inputs = reader.number<size_t>();
+            layer.outputs = reader.number<size_t>();
+            const auto activation = reader.word();
+            if (activation == "relu") {
+                layer.activation = Activation::relu;
+            }
+            else if (activation == "tanh") {
+                layer.activation = Activation::tanh;
+            }
+            else if (activation == "linear") {
+                layer.activation = Activation::linear;
+            }
+            else {
+                throw omnetpp::cRuntimeError("Unknown policy activation '%s'", activation.c_str());
+            }
+            if (!layers.empty() && layers.back().outputs != layer.inputs) {
+                throw omnetpp::cRuntimeError("Policy layer with %zu inputs follows one with %zu outputs", layer.inputs, layers.back().outputs);
+            }
+            layer.weights.resize(layer.inputs * layer.outputs);
+            for (auto& weight : layer.weights) {
+                weight = reader.number<double>();
+            }
+            layer.biases.resize(layer.outputs);
+            for (auto& bias : layer.biases) {
+                bias = reader.number<double>();
+            }
+            layers.push_back(std::move(layer));
+        }
+        else if (section == "lut") {
+            if (!lutBins.empty()) {
+                throw omnetpp::cRuntimeError("Policy file '%s' has more than one lookup table", fileName.c_str());
+            }
+            const auto dimensions = reader.number<size_t>();
+            if (dimensions == 0) {
+                throw omnetpp::cRuntimeError("Policy lookup table in '%s' needs at least one dimension", fileName.c_str());
+            }
+            size_t cells = 1;
+            for (size_t i = 0; i < dimensions; ++i) {
+                lutBins.push_back(reader.number<size_t>());
+                if (lutBins.back() == 0) {
+                    throw omnetpp::cRuntimeError("Policy lookup table dimension %zu in '%s' has no bins", i, fileName.c_str());
+                }
+                cells *= lutBins.back();
+            }
+            for (size_t i = 0; i < dimensions; ++i) {
+                if (reader.word() != "range") {
+                    throw omnetpp::cRuntimeError("Expected a range for each lookup table dimension");
+                }
+                const auto low = reader.number<double>();
+                const auto high = reader.number<double>();
+                // also rejects NaN, the bins are computed relative to high - low
+                if (!(low < high) || !std::isfinite(high - low)) {
+                    throw omnetpp::cRuntimeError("Policy lookup table dimension %zu in '%s' has the empty or infinite range [%g, %g]", i, fileName.c_str(), low, high);
+                }
+                lutRanges.emplace_back(low, high);
+            }
+            lutActions.resize(cells);
+            for (auto& action : lutActions) {
+                action = reader.number<double>();
+            }
+        }
+        else {
+            throw omnetpp::cRuntimeError("Unknown section '%s' in policy file '%s'", section.c_str(), fileName.c_str());
+        }
+    }
+
+    if (layers.empty() && lutActions.empty()) {
+        throw omnetpp::cRuntimeError("Policy file '%s' has neither layers nor a lookup table", fileName.c_str());
+    }
+    // checked once all sections are read, the output may be given after the lookup table
+    for (const auto action : lutActions) {
+        if (!std::isfinite(action) || (discreteOutput && (action < 0 || action != std::floor(action)))) {
+            throw omnetpp::cRuntimeError("Policy lookup table in '%s' holds the action %g, which is not a valid %s action", fileName.c_str(), action, discreteOutput ? "Discrete" : "Box");
+        }
+    }
+    size_t widest = 0;
+    for (const auto& layer : layers) {
+        widest = std::max({widest, layer.inputs, layer.outputs});
+    }
+    inputs.reserve(widest);
+    outputs.reserve(widest);
+}
+
+void EmbeddedPolicy::answer(const veinsgym::proto::Request& request, veinsgym::proto::Reply* reply)
+{
+    reply->set_id(request.id());
+    if (request.has_step()) {
+        act(request.step().observation(), reply->mutable_action());
+    }
+    else if (request.has_batch_step()) {
+        auto* actions = reply->mutable_batch_action()->mutable_actions();
+        actions->Reserve(request.batch_step().steps_size());
+        for (const auto& item : request.batch_step().steps()) {
+            auto* answer = actions->Add();
+            answer->set_agent_id(item.agent_id());
+            act(item.step().observation(), answer->mutable_action());
+        }
+    }
+    // init, shutdown, and reset requests get an empty reply
+}
+
+void EmbeddedPolicy::act(const veinsgym::proto::Space& observation, veinsgym::proto::Space* action)
+{
+    if (!observation.has_box()) {
+        throw omnetpp::cRuntimeError("Embedded policies only support Box observations");
+    }
+    if (!layers.empty() && evaluateMlp(observation.box())) {
+        if (discreteOutput) {
+            action->mutable_discrete()->set_value(std::max_element(outputs.begin(), outputs.end()) - outputs.begin());
+        }
+        else {
+            auto* values = action->mutable_box()->mutable_values();
+            values->Reserve(outputs.size());
+            for (const auto value : outputs) {
+                values->AddAlreadyReserved(value);
+            }
+        }
+        return;
+    }
+
+    if (lutActions.empty()) {
+        throw omnetpp::cRuntimeError("Embedded policy produced a non-finite action and has no lookup table to fall back to");
+    }
+    const auto value = lookUp(observation.box());
+    if (discreteOutput) {
+        action->mutable_discrete()->set_value(static_cast<uint64_t>(value));
+    }
+    else {
+        action->mutable_box()->add_values(value);
+    }
+}
+
+bool EmbeddedPolicy::evaluateMlp(const veinsgym::proto::Box& observation)
+{
+    if (static_cast<size_t>(observation.values_size()) != layers.front().inputs) {
+        throw omnetpp::cRuntimeError("Embedded policy expects %zu observation values, got %d", layers.front().inputs, observation.values_size());
+    }
+    outputs.assign(observation.values().begin(), observation.values().end());
+    for (const auto& layer : layers) {
+        inputs.swap(outputs);
+        outputs.resize(layer.outputs);
+        const double* weights = layer.weights.data();
+        for (size_t o = 0; o < layer.outputs; ++o, weights += layer.inputs) {
+            double sum = layer.biases[o];
+            for (size_t i = 0; i < layer.inputs; ++i) {
+                sum += weights[i] * inputs[i];
+            }
+            switch (layer.activation) {
+            case Activation::relu:
+                sum = std::max(0.0, sum);
+                break;
+            case Activation::tanh:
+                sum = std::tanh(sum);
+                break;
+            case Activation::linear:
+                break;
+            }
+            outputs[o] = sum;
+        }
+    }
+    return std::all_of(outputs.begin(), outputs.end(), [](double value) { return std::isfinite(value); });
+}
+
+double EmbeddedPolicy::lookUp(const veinsgym::proto::Box& observation) const
+{
+    if (static_cast<size_t>(observation.values_size()) != lutBins.size()) {
+        throw omnetpp::cRuntimeError("Embedded policy lookup table expects %zu observation values, got %d", lutBins.size(), observation.values_size());
+    }
+    size_t cell = 0;
+    for (size_t i = 0; i < lutBins.size(); ++i) {
+        const auto& range = lutRanges[i];
+        // infinite values are clipped like any other, NaN has no cell
+        if (std::isnan(observation.values(i))) {
+            throw omnetpp::cRuntimeError("Embedded policy lookup table got NaN as observation value %zu", i);
+        }
+        const auto relative = (observation.values(i) - range.first) / (range.second - range.first);
+        const auto bin = static_cast<size_t>(std::min(std::max(relative, 0.0), 1.0) * (lutBins[i] - 1) + 0.5);
+        cell = cell * lutBins[i] + bin;
+    }
+    return lutActions[cell];
+}
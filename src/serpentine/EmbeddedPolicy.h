@@ -0,0 +1,86 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "protobuf/veinsgym.pb.h"
+
+/**
+ * Exported agent policy that is evaluated in-process instead of by a gym server.
+ *
+ * Lets GymConnection answer step requests at simulation speed for evaluation runs of a trained agent.
+ * The policy file is plain text, whitespace separated, and '#' starts a comment until the end of the line:
+ *
+ *     serpentine-policy 1
+ *     output discrete|box       -- argmax of the outputs is a Discrete action, or the outputs form a Box action
+ *     layer <in> <out> relu|tanh|linear
+ *     <out x in weights, row by row> <out biases>
+ *     ...                       -- further layers, the first takes the observation
+ *     lut <dimensions> <bins of each dimension, at least one>
+ *     range <low> <high>        -- once per observation dimension with low < high, values outside are clipped
+ *     <one action per cell, the last dimension varies fastest, non-negative whole numbers for Discrete actions>
+ *
+ * Both the MLP layers and the lookup table are optional, but one of them is required. There is at most one lookup table.
+ * The lookup table answers when there is no MLP or the MLP yields a non-finite output, it clips infinite observation values and rejects NaN.
+ * Lookup table actions are Discrete values, or the first output of a Box action.
+ */
+class EmbeddedPolicy {
+public:
+    explicit EmbeddedPolicy(const std::string& fileName);
+
+    // answers a request like the gym server would
+    void answer(const veinsgym::proto::Request& request, veinsgym::proto::Reply* reply);
+
+private:
+    enum class Activation {
+        relu,
+        tanh,
+        linear
+    };
+
+    struct Layer {
+        size_t inputs;
+        size_t outputs;
+        Activation activation;
+        std::vector<double> weights; // row-major, one row per output
+        std::vector<double> biases;
+    };
+
+    void act(const veinsgym::proto::Space& observation, veinsgym::proto::Space* action);
+    bool evaluateMlp(const veinsgym::proto::Box& observation);
+    double lookUp(const veinsgym::proto::Box& observation) const;
+
+    bool discreteOutput = true;
+    std::vector<Layer> layers;
+    std::vector<size_t> lutBins;
+    std::vector<std::pair<double, double>> lutRanges;
+    std::vector<double> lutActions;
+
+    // scratch space of the forward pass, outputs ends up holding the MLP result
+    std::vector<double> inputs;
+    std::vector<double> outputs;
+};
@@ -22,9 +22,226 @@
 
 #include "serpentine/GymConnection.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <climits>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+
+#include "veins/base/utils/FindModule.h"
+#include "veins/modules/mobility/traci/TraCIScenarioManagerForker.h"
+#include "serpentine/GymSplitter.h"
+#include "serpentine/ObservationFeature.h"
+#include "serpentine/SerpentineApp.h"
+
 Define_Module(GymConnection);
 
-void GymConnection::initialize()
+/*
+ * Restoring re-creates the vehicles from the SUMO state and hands them the state captured here, with times kept relative to the snapshot.
+ * Not captured, and thus started afresh on restore: the MAC and PHY layers (queues, backoff, channel state, busy time counters),
+ * frames in the air, whose packets count as lost, steps still awaiting an answer in async or batched mode, and the random number streams.
+ */
+struct GymConnection::Snapshot {
+    std::string stateFile;
+    omnetpp::simtime_t episodeElapsed;
+    std::map<std::string, GymSplitter::SnapshotState> agents; // by vehicle id
+    std::map<std::string, veins::serpentine::SerpentineApp::SnapshotState> apps; // by vehicle id
+    DeliveryTracker deliveries; // of the packets the agents have not been rewarded for yet, send times relative to the snapshot
+};
+
+namespace {
+
+google::protobuf::ArenaOptions arenaOptions(char* initialBlock, size_t size)
+{
+    google::protobuf::ArenaOptions options;
+    options.initial_block = initialBlock;
+    options.initial_block_size = size;
+    return options;
+}
+
+// splitmix64 finalizer, spreads neighbouring inputs over the whole range
+uint64_t mixSeed(uint64_t value)
+{
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+// keep the default seed sets of resets and snapshot restores apart
+const uint64_t resetSeedPurpose = 1;
+const uint64_t restoreSeedPurpose = 2;
+
+} // namespace
+
+GymConnection::GymConnection()
+    : requestArenaBlock(new char[arenaBlockSize])
+    , replyArenaBlock(new char[arenaBlockSize])
+    , requestArena(arenaOptions(requestArenaBlock.get(), arenaBlockSize))
+    , replyArena(arenaOptions(replyArenaBlock.get(), arenaBlockSize))
+{
+}
+
+GymConnection::~GymConnection()
+{
+    cancelAndDelete(flushBatchTrigger);
+    cancelAndDelete(endEpisodeTrigger);
+}
+
+void GymConnection::initialize(int stage)
+{
+    if (stage == 2) {
+        // after the manager had its chance to fork workers, so every worker connects to its own agent and writes its own files
+        stateFile = environmentFile(par("stateFile").stdstringValue());
+        snapshotFilePrefix = environmentFile(par("snapshotFilePrefix").stdstringValue());
+        connect();
+        return;
+    }
+    if (stage != 0) {
+        return;
+    }
+
+    asyncMode = par("asyncMode");
+    latencyBudget = par("latencyBudget");
+    batchSteps = par("batchSteps");
+    if (asyncMode && batchSteps) {
+        throw omnetpp::cRuntimeError("asyncMode and batchSteps cannot be combined");
+    }
+    agentWaitTimeSignal = registerSignal("agentWaitTime");
+
+    // several environments in one network share the connection of the first one, their agent ids are prefixed by the environment index
+    const auto scenario = veins::FindModule<>::findScenario(this);
+    if (scenario != getSystemModule()) {
+        if (!batchSteps) {
+            throw omnetpp::cRuntimeError("Environments sharing a simulation process need batchSteps");
+        }
+        primary = veins::FindModule<GymConnection*>::findSubModule(getSystemModule());
+        environmentId = std::to_string(scenario->getIndex());
+        primary->environments[environmentId] = this;
+    }
+    ++primary->openEnvironments;
+
+    // run after all other events of a time step, so every agent deciding at that time is part of the batch
+    flushBatchTrigger = new omnetpp::cMessage("flushBatch");
+    flushBatchTrigger->setSchedulingPriority(1);
+
+    episodes = par("episodes");
+    episodeLength = par("episodeLength");
+    endEpisodeTrigger = new omnetpp::cMessage("endEpisode");
+    scenario->subscribe(veins::TraCIScenarioManager::traciStateLoadedSignal, this);
+    scenario->subscribe(veins::TraCIScenarioManager::traciModuleAddedSignal, this);
+    scenario->subscribe(veins::TraCIScenarioManager::traciModuleRemovedSignal, this);
+    if (episodes != 1 && episodeLength > 0) {
+        scheduleAt(episodeLength, endEpisodeTrigger);
+    }
+}
+
+void GymConnection::connect()
+{
+    if (primary != this) {
+        return;
+    }
+    if (!environmentId.empty() && veins::TraCIScenarioManagerForkerAccess().get(this) && veins::TraCIScenarioManagerForkerAccess().get(this)->par("workers").intValue() > 1) {
+        throw omnetpp::cRuntimeError("Environments sharing a simulation process cannot fork workers");
+    }
+
+    const std::string transport = par("transport");
+    if (transport == "policy") {
+        const std::string fileName = par("policyFile");
+        EV_INFO << "Evaluating embedded policy '" << fileName << "'\n";
+        policy.reset(new EmbeddedPolicy(fileName));
+    }
+    else if (transport == "shm") {
+        const auto name = resolveEndpoint();
+        EV_INFO << "Creating shared memory segment '" << name << "'\n";
+        shm.reset(new ShmChannel(name, par("shmSlots").intValue(), par("shmSlotSize").intValue()));
+        const double shmTimeout = par("shmTimeout");
+        shmTimeoutMs = shmTimeout > 0 ? static_cast<long>(shmTimeout * 1000) : -1;
+    }
+    else {
+        std::string address;
+        if (transport == "tcp") {
+            address = "tcp://" + resolveHostAndPort();
+        }
+        else if (transport == "ipc" || transport == "inproc") {
+            address = transport + "://" + resolveEndpoint();
+        }
+        else {
+            throw omnetpp::cRuntimeError("Unknown gym transport '%s'", transport.c_str());
+        }
+
+        // a DEALER socket talks to the same REP server, but does not enforce strict send/recv alternation
+        socket = zmq::socket_t(getContext(), asyncMode ? zmq::socket_type::dealer : zmq::socket_type::req);
+        socket.setsockopt(ZMQ_LINGER, 0);
+
+        EV_INFO << "Connecting to server '" << address << "'" << (asyncMode ? " in async mode" : "") << "\n";
+        socket.connect(address);
+    }
+
+	veinsgym::proto::Request init_request;
+	*(init_request.mutable_init()->mutable_observation_space_code()) = observationSpaceCode();
+	*(init_request.mutable_init()->mutable_action_space_code()) = par("action_space").stdstringValue();
+	communicate(init_request); // ignore (empty) reply
+}
+
+zmq::context_t& GymConnection::getContext()
+{
+    if (!context) {
+        context.reset(new zmq::context_t(1));
+    }
+    return *context;
+}
+
+std::string GymConnection::observationSpaceCode() const
+{
+    const std::string code = par("observation_space");
+    if (code != "") {
+        return code;
+    }
+
+    // derive a Box from the bounds of the configured features
+    std::ostringstream low;
+    std::ostringstream high;
+    low.precision(17);
+    high.precision(17);
+    const auto formatBound = [](std::ostringstream& os, double value) {
+        if (std::isinf(value)) {
+            os << (value < 0 ? "-np.inf" : "np.inf");
+        }
+        else {
+            os << value;
+        }
+    };
+    size_t count = 0;
+    for (const auto& feature : createObservationFeatures()) {
+        for (size_t i = 0; i < feature->size(); ++i, ++count) {
+            const auto bounds = feature->bounds(i);
+            low << (count > 0 ? ", " : "");
+            high << (count > 0 ? ", " : "");
+            formatBound(low, bounds.first);
+            formatBound(high, bounds.second);
+        }
+    }
+    return "gym.spaces.Box(low=np.array([" + low.str() + "], dtype=np.float32), high=np.array([" + high.str() + "], dtype=np.float32))";
+}
+
+std::vector<std::unique_ptr<ObservationFeature>> GymConnection::createObservationFeatures() const
+{
+    std::vector<std::unique_ptr<ObservationFeature>> features;
+    omnetpp::cStringTokenizer tokenizer(par("observationFeatures").stringValue());
+    while (tokenizer.hasMoreTokens()) {
+        const char* name = tokenizer.nextToken();
+        features.emplace_back(omnetpp::check_and_cast<ObservationFeature*>(omnetpp::createOne(name)));
+    }
+    if (features.empty()) {
+        throw omnetpp::cRuntimeError("No observation features configured");
+    }
+    return features;
+}
+
+std::string GymConnection::resolveHostAndPort() const
 {
     // determine host and port from params and ENV variables
     std::string host = par("host");
@@ -46,24 +263,530 @@ void GymConnection::initialize()
             throw omnetpp::cRuntimeError("Gym port not configured! Change your ini file or set VEINS_GYM_PORT");
         }
     }
+    return host + ":" + std::to_string(port + workerIndex());
+}
 
-    EV_INFO << "Connecting to server 'tcp://" << host << ":" << port << "'\n";
-    socket.connect("tcp://" + host + ":" + std::to_string(port));
+std::string GymConnection::resolveEndpoint() const
+{
+    std::string endpoint = par("endpoint");
+    if (endpoint == "") { // param empty, check environment
+        if (std::getenv("VEINS_GYM_ENDPOINT") != nullptr) {
+            endpoint = std::getenv("VEINS_GYM_ENDPOINT");
+        } else {
+            // param and environment empty, fail
+            throw omnetpp::cRuntimeError("Gym endpoint not configured! Change your ini file or set VEINS_GYM_ENDPOINT");
+        }
+    }
+    const int worker = workerIndex();
+    return worker > 0 ? endpoint + "-" + std::to_string(worker) : endpoint;
+}
 
-	veinsgym::proto::Request init_request;
-	*(init_request.mutable_init()->mutable_observation_space_code()) = par("observation_space").stdstringValue();
-	*(init_request.mutable_init()->mutable_action_space_code()) = par("action_space").stdstringValue();
-	communicate(init_request); // ignore (empty) reply
+int GymConnection::workerIndex() const
+{
+    const auto forker = veins::TraCIScenarioManagerForkerAccess().get(this);
+    return forker ? forker->getWorkerIndex() : 0;
 }
 
-veinsgym::proto::Reply GymConnection::communicate(veinsgym::proto::Request request)
+void GymConnection::finish()
 {
-    std::string request_msg = request.SerializeAsString();
-    socket.send(zmq::message_t(request_msg.data(), request_msg.size()), zmq::send_flags::none);
-    zmq::message_t response_msg;
-    socket.recv(response_msg);
-    std::string response(static_cast<char*>(response_msg.data()), response_msg.size());
-    veinsgym::proto::Reply reply;
-    reply.ParseFromString(response);
+    if (!environmentId.empty() && primary == this && !shutDown) {
+        // environments sharing the agent all end here, before any of them is torn down
+        veinsgym::proto::Request request;
+        request.set_id(1);
+        *(request.mutable_shutdown()) = {};
+        shutDown = true;
+        exchange(request);
+    }
+    if (recorder) {
+        recorder->flush();
+    }
+    recordScalar("missedLatencyBudgets", missedBudgets);
+}
+
+void GymConnection::handleMessage(omnetpp::cMessage* msg)
+{
+    if (msg == flushBatchTrigger) {
+        flushBatch();
+        return;
+    }
+    if (msg == endEpisodeTrigger) {
+        endEpisode();
+        return;
+    }
+    throw omnetpp::cRuntimeError("GymConnection received unknown message");
+}
+
+const veinsgym::proto::Reply& GymConnection::communicate(const veinsgym::proto::Request& request)
+{
+    const auto& reply = primary->exchange(request);
+    handleReply(reply);
+    return reply;
+}
+
+const veinsgym::proto::Reply& GymConnection::exchange(const veinsgym::proto::Request& request)
+{
+    Enter_Method_Silent();
+    // replies to pipelined requests are still in flight, hand them to their steps to keep the exchange in order
+    while (!postedSteps.empty()) {
+        answerPosted(receiveReply());
+    }
+
+    sendRequest(request);
+    const auto sent = std::chrono::steady_clock::now();
+    const auto& reply = receiveReply();
+    if (request.has_step() || request.has_batch_step()) {
+        emit(agentWaitTimeSignal, std::chrono::duration<double>(std::chrono::steady_clock::now() - sent).count());
+    }
     return reply;
 }
+
+TrajectoryRecorder* GymConnection::getRecorder(uint32_t observationSize)
+{
+    if (!recorder && par("trajectoryFile").stdstringValue() != "") {
+        recorder.reset(new TrajectoryRecorder(environmentFile(par("trajectoryFile").stdstringValue()), observationSize, par("trajectoryChunkSize").intValue()));
+    }
+    if (recorder && recorder->getObservationSize() != observationSize) {
+        throw omnetpp::cRuntimeError("Cannot record observations of different sizes to the same trajectory file");
+    }
+    return recorder.get();
+}
+
+veinsgym::proto::Request& GymConnection::stepRequest()
+{
+    saveInitialState();
+    // the previous step request has been serialized already, so its memory can be recycled
+    requestArena.Reset();
+    auto* request = google::protobuf::Arena::CreateMessage<veinsgym::proto::Request>(&requestArena);
+    request->set_id(1);
+    request->mutable_step();
+    return *request;
+}
+
+void GymConnection::post(const std::string& agentId, const veinsgym::proto::Request& request, ActionCallback callback)
+{
+    ASSERT(asyncMode);
+    sendRequest(request);
+    postedSteps.push_back({agentKey(agentId), std::move(callback)});
+}
+
+void GymConnection::collect()
+{
+    ASSERT(asyncMode);
+    if (postedSteps.empty()) {
+        return; // nothing posted yet, e.g., on the very first step
+    }
+
+    // take all replies that arrive within the latency budget
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::duration<double>(latencyBudget);
+    while (!postedSteps.empty()) {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (!pollReply(std::max(0L, static_cast<long>(remaining.count())))) {
+            break;
+        }
+        const auto& received = receiveReply();
+        handleReply(received);
+        answerPosted(received);
+    }
+    emit(agentWaitTimeSignal, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+    if (!postedSteps.empty()) {
+        ++missedBudgets;
+        EV_WARN << "Agent missed the latency budget of " << latencyBudget << "s, " << postedSteps.size() << " replies outstanding\n";
+    }
+}
+
+void GymConnection::answerPosted(const veinsgym::proto::Reply& reply)
+{
+    // the agent answers in order, so every reply belongs to the oldest step still waiting
+    const auto callback = std::move(postedSteps.front().callback);
+    postedSteps.erase(postedSteps.begin()); // keeps the capacity, only few steps are ever in flight
+    if (callback) {
+        callback(&reply.action());
+    }
+}
+
+void GymConnection::queueStep(const std::string& agentId, veinsgym::proto::Step step, ActionCallback callback)
+{
+    Enter_Method_Silent();
+    ASSERT(batchSteps);
+    saveInitialState();
+    // flushed along with the steps of all other environments sharing the primary
+    primary->enqueueStep({agentKey(agentId), std::move(step), std::move(callback)});
+}
+
+void GymConnection::enqueueStep(QueuedStep queued)
+{
+    Enter_Method_Silent();
+    queuedSteps.push_back(std::move(queued));
+    if (!flushBatchTrigger->isScheduled()) {
+        scheduleAt(omnetpp::simTime(), flushBatchTrigger);
+    }
+}
+
+void GymConnection::cancelSteps(const std::string& agentId)
+{
+    Enter_Method_Silent();
+    auto& queued = primary->queuedSteps;
+    const auto key = agentKey(agentId);
+    queued.erase(std::remove_if(queued.begin(), queued.end(), [&key](const QueuedStep& step) { return step.agentId == key; }), queued.end());
+    // posted steps stay in place, their replies are still on the way
+    for (auto& posted : postedSteps) {
+        if (posted.agentId == key) {
+            posted.callback = nullptr;
+        }
+    }
+}
+
+void GymConnection::flushBatch()
+{
+    auto batch = std::move(queuedSteps);
+    queuedSteps.clear();
+    if (batch.empty()) {
+        return;
+    }
+
+    veinsgym::proto::Request request;
+    request.set_id(1);
+    auto* steps = request.mutable_batch_step()->mutable_steps();
+    steps->Reserve(batch.size());
+    for (auto& queued : batch) {
+        auto* item = steps->Add();
+        item->set_agent_id(queued.agentId);
+        *(item->mutable_step()) = std::move(queued.step);
+    }
+    EV_INFO << "Sending batch of " << batch.size() << " steps\n";
+
+    const auto& reply = communicate(request);
+
+    std::map<std::string, const veinsgym::proto::Space*> actions;
+    for (const auto& item : reply.batch_action().actions()) {
+        actions[item.agent_id()] = &item.action();
+    }
+    for (auto& queued : batch) {
+        const auto action = actions.find(queued.agentId);
+        queued.callback(action != actions.end() ? action->second : nullptr);
+    }
+}
+
+void GymConnection::endEpisode()
+{
+    Enter_Method_Silent();
+    if (resetting || shutDown) {
+        return; // modules taken down by the reset itself do not end another episode
+    }
+
+    veinsgym::proto::Request request;
+    request.set_id(1);
+    const bool lastEpisode = episodes > 0 && episode + 1 >= static_cast<uint64_t>(episodes);
+    const bool running = omnetpp::getSimulation()->getSimulationStage() == omnetpp::CTX_EVENT;
+    if (!environmentId.empty() && !running) {
+        return; // the primary may be gone already, it shut the agent down in finish()
+    }
+    if (lastEpisode || !running) {
+        shutDown = true;
+        if (--primary->openEnvironments > 0) {
+            return; // the agent is still needed by the other environments
+        }
+        *(request.mutable_shutdown()) = {};
+        primary->shutDown = true;
+        communicate(request); // ignore (empty) reply
+        return;
+    }
+
+    EV_INFO << "Ending episode " << episode << "\n";
+    request.mutable_reset()->set_episode(episode + 1);
+    request.mutable_reset()->set_environment(environmentId);
+    const auto& reply = communicate(request);
+    if (!resetting) {
+        requestReset(reply.has_reset() ? reply.reset().seed() : 0);
+    }
+}
+
+void GymConnection::removeAgent()
+{
+    Enter_Method_Silent();
+    ASSERT(agents > 0);
+    if (--agents == 0) {
+        endEpisode(); // shuts the agent down unless another episode follows
+    }
+}
+
+void GymConnection::receiveSignal(omnetpp::cComponent* source, omnetpp::simsignal_t signalID, bool b, omnetpp::cObject* details)
+{
+    Enter_Method_Silent();
+    if (signalID != veins::TraCIScenarioManager::traciStateLoadedSignal || !resetting) {
+        return;
+    }
+    resetting = false;
+
+    omnetpp::simtime_t elapsed = 0;
+    if (restoring) {
+        // vehicles have just been re-created, hand their agents the state they had when the snapshot was taken
+        for (const auto& agent : restoring->agents) {
+            const auto vehicle = findVehicle(agent.first);
+            if (vehicle && vehicle->splitter) {
+                vehicle->splitter->restoreSnapshotState(agent.second);
+            }
+        }
+        for (const auto& app : restoring->apps) {
+            if (const auto vehicle = findVehicle(app.first)) {
+                for (const auto module : veins::getSubmodulesOfType<veins::serpentine::SerpentineApp>(vehicle->host)) {
+                    module->restoreSnapshotState(app.second);
+                }
+            }
+        }
+        deliveries = restoring->deliveries;
+        deliveries.shift(omnetpp::simTime());
+        elapsed = restoring->episodeElapsed;
+        restoring = nullptr;
+    }
+    else {
+        EV_INFO << "Starting episode " << episode << "\n";
+        deliveries.clear();
+    }
+
+    episodeStart = omnetpp::simTime() - elapsed;
+    if (episodes != 1 && episodeLength > 0) {
+        scheduleAt(episodeStart + episodeLength, endEpisodeTrigger);
+    }
+}
+
+void GymConnection::receiveSignal(omnetpp::cComponent* source, omnetpp::simsignal_t signalID, omnetpp::cObject* obj, omnetpp::cObject* details)
+{
+    Enter_Method_Silent();
+    auto host = omnetpp::check_and_cast<omnetpp::cModule*>(obj);
+    const auto mobilities = veins::getSubmodulesOfType<veins::TraCIMobility>(host);
+    if (mobilities.empty()) {
+        return;
+    }
+    const auto& id = mobilities.front()->getExternalId();
+
+    if (signalID == veins::TraCIScenarioManager::traciModuleAddedSignal) {
+        const auto splitters = veins::getSubmodulesOfType<GymSplitter>(host);
+        auto& vehicle = vehicles[id];
+        vehicle = {host, mobilities.front(), splitters.empty() ? nullptr : splitters.front()};
+        if (id == "leader") {
+            leader = &vehicle;
+            // choices repeated since the last decision were made for the previous leader, if any
+            for (auto& other : vehicles) {
+                if (other.second.splitter) {
+                    other.second.splitter->requestDecision();
+                }
+            }
+        }
+    }
+    else if (signalID == veins::TraCIScenarioManager::traciModuleRemovedSignal) {
+        if (id == "leader") {
+            leader = nullptr;
+        }
+        vehicles.erase(id);
+    }
+}
+
+const GymConnection::Vehicle* GymConnection::findVehicle(const std::string& id) const
+{
+    const auto vehicle = vehicles.find(id);
+    return vehicle != vehicles.end() ? &vehicle->second : nullptr;
+}
+
+void GymConnection::handleReply(const veinsgym::proto::Reply& reply)
+{
+    if (reply.has_reset() && reply.reset().environment() != environmentId) {
+        // the agent addressed another environment sharing this process
+        const auto target = primary->environments.find(reply.reset().environment());
+        if (target == primary->environments.end()) {
+            throw omnetpp::cRuntimeError("Agent asked to reset unknown environment '%s'", reply.reset().environment().c_str());
+        }
+        return target->second->handleReply(reply);
+    }
+    if (resetting) {
+        return;
+    }
+    if (reply.has_snapshot() && !environmentId.empty()) {
+        throw omnetpp::cRuntimeError("Snapshots are not supported while environments share a simulation process");
+    }
+    if (reply.has_reset() && episodes != 1) {
+        EV_INFO << "Agent ended episode " << episode << "\n";
+        requestReset(reply.reset().seed());
+    }
+    else if (reply.has_snapshot() && reply.snapshot().restore()) {
+        restoreSnapshot(reply.snapshot().id(), reply.snapshot().seed());
+    }
+    else if (reply.has_snapshot()) {
+        takeSnapshot(reply.snapshot().id());
+    }
+}
+
+void GymConnection::saveInitialState()
+{
+    if (episodes == 1 || stateSaved) {
+        return;
+    }
+    veins::TraCIScenarioManagerAccess().get(this)->getCommandInterface()->saveState(stateFile);
+    stateSaved = true;
+}
+
+void GymConnection::requestReset(uint64_t seed)
+{
+    ++episode;
+    reload(stateFile, seed ? seed : defaultSeedSet(resetSeedPurpose, episode), nullptr);
+}
+
+void GymConnection::takeSnapshot(uint64_t id)
+{
+    // SUMO saves the state of its last time step, which is what the vehicle modules currently reflect
+    const auto manager = veins::TraCIScenarioManagerAccess().get(this);
+    std::unique_ptr<Snapshot> snapshot(new Snapshot);
+    snapshot->stateFile = snapshotFilePrefix + std::to_string(id) + ".xml";
+    snapshot->episodeElapsed = omnetpp::simTime() - episodeStart;
+    manager->getCommandInterface()->saveState(snapshot->stateFile);
+    for (const auto& vehicle : vehicles) {
+        if (vehicle.second.splitter) {
+            snapshot->agents[vehicle.first] = vehicle.second.splitter->saveSnapshotState();
+        }
+        for (const auto app : veins::getSubmodulesOfType<veins::serpentine::SerpentineApp>(vehicle.second.host)) {
+            snapshot->apps[vehicle.first] = app->saveSnapshotState();
+        }
+    }
+    snapshot->deliveries = deliveries;
+    snapshot->deliveries.shift(-omnetpp::simTime());
+    EV_INFO << "Took snapshot " << id << " of " << snapshot->agents.size() << " agents\n";
+    snapshots[id] = std::move(snapshot);
+}
+
+void GymConnection::restoreSnapshot(uint64_t id, uint64_t seed)
+{
+    const auto snapshot = snapshots.find(id);
+    if (snapshot == snapshots.end()) {
+        throw omnetpp::cRuntimeError("Agent asked to restore unknown snapshot %lu", static_cast<unsigned long>(id));
+    }
+    EV_INFO << "Restoring snapshot " << id << "\n";
+    // random number streams cannot be captured, so restores of a snapshot with the same seed continue identically instead
+    reload(snapshot->second->stateFile, seed ? seed : defaultSeedSet(restoreSeedPurpose, id), snapshot->second.get());
+}
+
+void GymConnection::reload(const std::string& fileName, uint64_t seedSet, const Snapshot* snapshot)
+{
+    resetting = true;
+    restoring = snapshot;
+    cancelEvent(endEpisodeTrigger);
+    reseed(seedSet);
+    veins::TraCIScenarioManagerAccess().get(this)->loadStateAtNextTimestep(fileName);
+}
+
+std::string GymConnection::agentKey(const std::string& agentId) const
+{
+    return environmentId.empty() ? agentId : environmentId + "/" + agentId;
+}
+
+std::string GymConnection::environmentFile(const std::string& fileName) const
+{
+    // prefix the base name, so files stay in the configured directory
+    std::string prefix = environmentId.empty() ? "" : "env" + environmentId + "-";
+    if (workerIndex() > 0) {
+        prefix += "worker" + std::to_string(workerIndex()) + "-";
+    }
+    const auto base = fileName.rfind('/') + 1; // 0 without a directory
+    return fileName.substr(0, base) + prefix + fileName.substr(base);
+}
+
+uint64_t GymConnection::defaultSeedSet(uint64_t purpose, uint64_t offset) const
+{
+    // distinct per run seed set, forked worker, environment, and reset or restore, then folded into the seed sets OMNeT++ accepts
+    const uint64_t environment = environmentId.empty() ? 0 : std::strtoull(environmentId.c_str(), nullptr, 10) + 1;
+    uint64_t seed = mixSeed(std::strtoull(getEnvir()->getConfigEx()->getVariable("seedset"), nullptr, 10));
+    for (const uint64_t part : {static_cast<uint64_t>(workerIndex()), environment, purpose, offset}) {
+        seed = mixSeed(seed ^ part);
+    }
+    return seed % (static_cast<uint64_t>(INT_MAX) + 1);
+}
+
+void GymConnection::reseed(uint64_t seedSet)
+{
+    if (seedSet > static_cast<uint64_t>(INT_MAX)) {
+        throw omnetpp::cRuntimeError("Agent asked for seed %llu, but seeds must not exceed %d", static_cast<unsigned long long>(seedSet), INT_MAX);
+    }
+    EV_INFO << "Re-seeding random number generators with seed set " << seedSet << "\n";
+    auto* envir = getEnvir();
+    for (int i = 0; i < envir->getNumRNGs(); ++i) {
+        if (!environmentId.empty() && envir->getRNG(i) != getRNG(0)) {
+            continue; // environments sharing the process keep the other environments' streams, each is expected to map its rng-0 to a stream of its own
+        }
+        envir->getRNG(i)->initialize(static_cast<int>(seedSet), i, envir->getNumRNGs(), 0, 1, envir->getConfig());
+    }
+}
+
+void GymConnection::sendRequest(const veinsgym::proto::Request& request)
+{
+    if (policy) {
+        // replies are recycled once all have been received, they keep the capacity of their fields
+        if (answeredPolicyReplies == policyReplies.size()) {
+            policyReplies.emplace_back();
+        }
+        auto& answer = policyReplies[answeredPolicyReplies++];
+        answer.Clear();
+        policy->answer(request, &answer);
+        return;
+    }
+
+    if (shm) {
+        // serialize in place into the next free slot
+        const size_t size = request.ByteSizeLong();
+        auto* slot = shm->reserveRequest(size, shmTimeoutMs);
+        if (!slot) {
+            throw omnetpp::cRuntimeError("Agent did not take requests from shared memory segment '%s' for %ld ms", shm->getName().c_str(), shmTimeoutMs);
+        }
+        request.SerializeWithCachedSizesToArray(slot);
+        shm->commitRequest(size);
+        return;
+    }
+
+    if (asyncMode) {
+        socket.send(zmq::message_t(), zmq::send_flags::sndmore); // empty delimiter frame expected by REP
+    }
+    socket.send(sendBuffers.serialize(request), zmq::send_flags::none);
+}
+
+const veinsgym::proto::Reply& GymConnection::receiveReply()
+{
+    // only the freshest reply is ever in use, so the arena can be recycled
+    replyArena.Reset();
+    reply = google::protobuf::Arena::CreateMessage<veinsgym::proto::Reply>(&replyArena);
+    if (policy) {
+        reply->CopyFrom(policyReplies[receivedPolicyReplies++]);
+        if (receivedPolicyReplies == answeredPolicyReplies) {
+            answeredPolicyReplies = receivedPolicyReplies = 0;
+        }
+        return *reply;
+    }
+    if (shm) {
+        if (!shm->waitForReply(shmTimeoutMs)) {
+            throw omnetpp::cRuntimeError("Agent did not reply on shared memory segment '%s' for %ld ms", shm->getName().c_str(), shmTimeoutMs);
+        }
+        const auto payload = shm->peekReply();
+        reply->ParseFromArray(payload.first, payload.second);
+        shm->releaseReply();
+        return *reply;
+    }
+
+    if (asyncMode) {
+        socket.recv(receiveBuffer); // empty delimiter frame
+    }
+    socket.recv(receiveBuffer);
+    sendBuffers.release(); // the agent is done with the request this reply answers
+    reply->ParseFromArray(receiveBuffer.data(), receiveBuffer.size());
+    return *reply;
+}
+
+bool GymConnection::pollReply(long timeoutMs)
+{
+    if (policy) {
+        return receivedPolicyReplies < answeredPolicyReplies;
+    }
+    if (shm) {
+        return shm->waitForReply(timeoutMs);
+    }
+    zmq::pollitem_t items[] = {{socket.handle(), 0, ZMQ_POLLIN, 0}};
+    return zmq::poll(items, 1, timeoutMs) > 0;
+}
@@ -22,16 +22,170 @@
 
 #pragma once
 
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <google/protobuf/arena.h>
 #include <zmq/zmq.hpp>
 #include <omnetpp.h>
 #include "protobuf/veinsgym.pb.h"
+#include "serpentine/DeliveryTracker.h"
+#include "serpentine/EmbeddedPolicy.h"
+#include "serpentine/SendBufferPool.h"
+#include "serpentine/ShmChannel.h"
+#include "serpentine/TrajectoryRecorder.h"
 
+namespace veins {
+class TraCIMobility;
+}
+class GymSplitter;
+class ObservationFeature;
 
-class GymConnection : public omnetpp::cSimpleModule {
+class GymConnection : public omnetpp::cSimpleModule, public omnetpp::cListener {
 public:
-    void initialize() override;
-    veinsgym::proto::Reply communicate(veinsgym::proto::Request request);
+    using ActionCallback = std::function<void(const veinsgym::proto::Space* action)>; // action is nullptr if the agent did not answer
+
+    // typed handles to the submodules of a managed vehicle, resolved once when the vehicle is added
+    struct Vehicle {
+        omnetpp::cModule* host;
+        veins::TraCIMobility* mobility;
+        GymSplitter* splitter;
+    };
+
+    GymConnection();
+    ~GymConnection() override;
+    int numInitStages() const override { return 3; }
+    void initialize(int stage) override;
+    void finish() override;
+    void handleMessage(omnetpp::cMessage* msg) override;
+    const veinsgym::proto::Reply& communicate(const veinsgym::proto::Request& request);
+    veinsgym::proto::Request& stepRequest();
+    zmq::context_t& getContext(); // for agents embedded via inproc://, created on first use
+    TrajectoryRecorder* getRecorder(uint32_t observationSize); // nullptr unless transitions are to be recorded
+
+    // pipelined step interface, only available in async mode
+    bool isAsync() const { return asyncMode; }
+    void post(const std::string& agentId, const veinsgym::proto::Request& request, ActionCallback callback); // callback gets the action once the reply arrives
+    void collect(); // hands the replies arriving within the latency budget to the callbacks of their steps
+
+    // batched step interface, steps queued at the same simulation time share one round-trip
+    bool isBatched() const { return batchSteps; }
+    void queueStep(const std::string& agentId, veinsgym::proto::Step step, ActionCallback callback);
+    void cancelSteps(const std::string& agentId);
+
+    // episodes are separated by reloading the SUMO state of the first step instead of restarting the simulation
+    bool isResetting() const { return resetting; }
+    void endEpisode();
+
+    // learning vehicles, the episode ends early once the last of them left
+    void addAgent() { ++agents; }
+    void removeAgent();
+    void receiveSignal(omnetpp::cComponent* source, omnetpp::simsignal_t signalID, bool b, omnetpp::cObject* details) override;
+
+    // registry of the managed vehicles, kept up to date from the TraCIScenarioManager's module signals
+    const Vehicle* getLeader() const { return leader; }
+    const Vehicle* findVehicle(const std::string& id) const;
+    const std::unordered_map<std::string, Vehicle>& getVehicles() const { return vehicles; }
+
+    // receptions of the packets sent by agents, for their rewards
+    DeliveryTracker& getDeliveries() { return deliveries; }
+
+    // observation pipeline, the features named in observationFeatures are concatenated into one Box
+    std::vector<std::unique_ptr<ObservationFeature>> createObservationFeatures() const;
+    void receiveSignal(omnetpp::cComponent* source, omnetpp::simsignal_t signalID, omnetpp::cObject* obj, omnetpp::cObject* details) override;
+
 private:
-    zmq::context_t context = zmq::context_t(1);
-    zmq::socket_t socket = zmq::socket_t(context, zmq::socket_type::req);
+    struct Snapshot; // branching point requested by the agent, see takeSnapshot()
+
+    struct QueuedStep {
+        std::string agentId;
+        veinsgym::proto::Step step;
+        ActionCallback callback;
+    };
+
+    struct PostedStep {
+        std::string agentId;
+        ActionCallback callback; // empty once the agent was cancelled
+    };
+
+    void connect();
+    std::string observationSpaceCode() const;
+    void enqueueStep(QueuedStep queued);
+    void flushBatch();
+    std::string resolveHostAndPort() const;
+    std::string resolveEndpoint() const;
+    int workerIndex() const;
+
+    void sendRequest(const veinsgym::proto::Request& request);
+    const veinsgym::proto::Reply& receiveReply();
+    bool pollReply(long timeoutMs);
+    const veinsgym::proto::Reply& exchange(const veinsgym::proto::Request& request);
+    void handleReply(const veinsgym::proto::Reply& reply);
+    void answerPosted(const veinsgym::proto::Reply& reply);
+    std::string agentKey(const std::string& agentId) const;
+    std::string environmentFile(const std::string& fileName) const; // prefixed per environment and worker, so none of them overwrite each other's files
+    void saveInitialState();
+    void requestReset(uint64_t seed);
+    void takeSnapshot(uint64_t id);
+    void restoreSnapshot(uint64_t id, uint64_t seed);
+    void reload(const std::string& fileName, uint64_t seedSet, const Snapshot* snapshot);
+    void reseed(uint64_t seedSet);
+    uint64_t defaultSeedSet(uint64_t purpose, uint64_t offset) const;
+
+    // environments sharing one network and process reach the agent through the first one's connection
+    GymConnection* primary = this;
+    std::string environmentId; // index of the environment, empty unless several share the process
+    std::map<std::string, GymConnection*> environments; // on the primary: all sharing it, by environment id
+    unsigned int openEnvironments = 0; // on the primary: environments that did not shut down yet
+
+    bool asyncMode = false;
+    bool batchSteps = false;
+    std::vector<QueuedStep> queuedSteps;
+    omnetpp::cMessage* flushBatchTrigger = nullptr;
+    double latencyBudget = 0;
+    std::vector<PostedStep> postedSteps; // not answered yet, in the order the agent answers them
+    long missedBudgets = 0;
+    omnetpp::simsignal_t agentWaitTimeSignal;
+
+    int episodes = 1;
+    omnetpp::simtime_t episodeLength;
+    std::string stateFile;
+    std::string snapshotFilePrefix;
+    uint64_t episode = 0;
+    omnetpp::simtime_t episodeStart;
+    std::map<uint64_t, std::unique_ptr<Snapshot>> snapshots;
+    const Snapshot* restoring = nullptr; // snapshot being restored while the SUMO state is reloaded
+    bool stateSaved = false;
+    bool resetting = false;
+    bool shutDown = false;
+    omnetpp::cMessage* endEpisodeTrigger = nullptr;
+    unsigned int agents = 0; // learning vehicles currently in the simulation
+
+    std::unordered_map<std::string, Vehicle> vehicles; // by vehicle id
+    const Vehicle* leader = nullptr; // element of vehicles, which keeps it in place
+    DeliveryTracker deliveries;
+
+    // per-step messages live on arenas that are reset before reuse, their first blocks are preallocated
+    static constexpr size_t arenaBlockSize = 16 * 1024;
+    std::unique_ptr<char[]> requestArenaBlock;
+    std::unique_ptr<char[]> replyArenaBlock;
+    google::protobuf::Arena requestArena;
+    google::protobuf::Arena replyArena;
+    veinsgym::proto::Reply* reply = nullptr;
+    SendBufferPool sendBuffers; // of requests sent over the socket
+
+    std::unique_ptr<zmq::context_t> context; // not before connect(), so no context is carried across the fork of TraCIScenarioManagerForker
+    zmq::socket_t socket;
+    zmq::message_t receiveBuffer;
+    std::unique_ptr<ShmChannel> shm; // replaces the socket for the shm transport
+    long shmTimeoutMs = -1; // wall-clock time to wait for the agent on the shared memory rings, negative: forever
+    std::unique_ptr<TrajectoryRecorder> recorder;
+    std::unique_ptr<EmbeddedPolicy> policy; // replaces the agent for the policy transport
+    std::vector<veinsgym::proto::Reply> policyReplies; // answered already, reused once all have been received
+    size_t answeredPolicyReplies = 0;
+    size_t receivedPolicyReplies = 0;
 };
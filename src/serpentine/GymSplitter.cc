@@ -21,6 +21,7 @@
 #include <cmath>
 #include <cstdlib>
 #include <array>
+#include "veins/base/utils/FindModule.h"
 #include "veins/modules/mobility/traci/TraCIMobility.h"
 #include "veins/modules/mobility/traci/TraCIScenarioManager.h"
 
@@ -28,10 +29,7 @@ Define_Module(GymSplitter);
 
 GymSplitter::~GymSplitter() {
     if (gymCon) {
-        veinsgym::proto::Request request;
-        request.set_id(1);
-		*(request.mutable_shutdown()) = {};
-		auto response = gymCon->communicate(request);
+        gymCon->removeAgent(); // the last learning vehicle to leave ends the episode
     }
 }
 
@@ -44,20 +42,26 @@ void GymSplitter::initialize()
     ASSERT(mobilityModules.size() == 1);
     mobility = mobilityModules.front();
 
-    // determine leader/follower role
-    isFollower = mobilityModules.front()->getExternalId() == "follower";
+    // determine leader/follower role, learning vehicles are named "follower" (or "follower.<n>" for platoons)
+    isFollower = mobilityModules.front()->getExternalId().rfind("follower", 0) == 0;
     EV_INFO << "Initialized vehicle '" << mobilityModules.front()->getExternalId() << "' as " << (isFollower ? "Follower" : "Leader") << "\n";
 
+    // every vehicle reports its receptions, agents need them to compute their rewards
+    if (auto connection = veins::FindModule<GymConnection*>::findGlobalModule(this)) {
+        deliveries = &connection->getDeliveries();
+    }
+
     // set up socket for follower vehicle
     if (isFollower) {
-        gymCon = veins::FindModule<GymConnection*>::findGlobalModule();
+        gymCon = veins::FindModule<GymConnection*>::findGlobalModule(this);
         ASSERT(gymCon);
+        gymCon->addAgent();
 
         // update headway if specified
         double desiredHeadway = par("desiredHeadway");
         if (desiredHeadway > 0) {
             // set via traci
-            const auto manager = veins::TraCIScenarioManagerAccess().get();
+            const auto manager = veins::TraCIScenarioManagerAccess().get(this);
             auto iface = manager->getCommandInterface();
             auto traci_vehicle = iface->vehicle(mobilityModules.front()->getExternalId());
             traci_vehicle.setTau(desiredHeadway);
@@ -66,69 +70,256 @@ void GymSplitter::initialize()
         success_reward = par("successReward");
         dsrc_cost = par("dsrcCost");
         vlc_cost = par("vlcCost");
-        max_range = par("maxRange");
+        deliveryTimeout = par("deliveryTimeout");
+        fallbackAction = par("fallbackAction");
+        decisionInterval = par("decisionInterval");
+        observationThreshold = par("observationThreshold");
+
+        size_t observationSize = 0;
+        features = gymCon->createObservationFeatures();
+        for (auto& feature : features) {
+            feature->initialize(this);
+            observationSize += feature->size();
+        }
+        currentObservation.assign(observationSize, 0);
+        decisionObservation.assign(observationSize, 0);
     }
 }
 
 GymSplitter::Interfaces GymSplitter::getAccessTechnology(cPacket *msg) {
     Interfaces result = {Interface::dsrc, Interface::vlc_head, Interface::vlc_tail};
-    const auto manager = veins::TraCIScenarioManagerAccess().get();
-    const auto managedModules = manager->getManagedHosts();
-    if (gymCon && managedModules.find("leader") != managedModules.end()) {
-        const auto leaderHost = managedModules.at("leader");
-        const auto observation = computeObservation(veins::TraCIMobilityAccess().get(leaderHost));
-        const auto reward = computeReward(veins::getSubmodulesOfType<GymSplitter>(leaderHost).front());
-        const auto request = serializeObservation(observation, reward);
-
-        auto response = gymCon->communicate(request);
+    const auto leader = findLeader();
+    if (gymCon && leader && !gymCon->isResetting() && !decisionDue(*leader)) {
+        result = lastChoice;
+    }
+    else if (gymCon && leader && !gymCon->isResetting()) {
+        auto& request = gymCon->stepRequest();
+        computeStep(*leader, request.mutable_step());
 
-        result = Interfaces(response.action().discrete().value());
+        if (gymCon->isAsync()) {
+            // pipelined: act on the freshest reply to an earlier step while the agent works on this one
+            gymCon->collect();
+            result = replyWaiting ? repliedChoice : fallbackChoice(result);
+            replyWaiting = false;
+            postStep(request);
+        }
+        else {
+            const auto& response = gymCon->communicate(request);
+            result = Interfaces(response.action().discrete().value());
+            recordTransition(static_cast<int32_t>(result.to_ulong()), false);
+        }
     }
     EV_INFO << "Using the following access technologies: " << result.to_string() << " \n";
-    lastChoice = result;
-    lastSentId = msg->getTreeId();
+    trackSent(msg, result);
     return result;
 }
 
+void GymSplitter::handleUpperMessage(cMessage* msg) {
+    const auto leader = findLeader();
+    if (!gymCon || !gymCon->isBatched() || gymCon->isResetting() || !leader) {
+        return Splitter::handleUpperMessage(msg);
+    }
+
+    auto wsm = check_and_cast<BaseFrame1609_4*>(msg);
+    if (!decisionDue(*leader)) {
+        return sendWithChoice(wsm, lastChoice);
+    }
+
+    // hold the packet until the batch of all agents deciding at this time has been answered
+    veinsgym::proto::Step step;
+    computeStep(*leader, &step);
+    heldPackets.insert(wsm);
+    gymCon->queueStep(mobility->getExternalId(), std::move(step), [this, wsm](const veinsgym::proto::Space* action) {
+        sendBatched(wsm, action);
+    });
+}
+
+void GymSplitter::postStep(const veinsgym::proto::Request& request) {
+    // the row of this step is recorded once its reply arrives, with the observation and reward sent along
+    postedSteps.push_back({simTime(), decisionReward});
+    postedObservations.insert(postedObservations.end(), currentObservation.begin(), currentObservation.end());
+    gymCon->post(mobility->getExternalId(), request, [this](const veinsgym::proto::Space* action) {
+        answerPosted(action);
+    });
+}
+
+void GymSplitter::answerPosted(const veinsgym::proto::Space* action) {
+    if (action) {
+        repliedChoice = Interfaces(action->discrete().value());
+        replyWaiting = true;
+        recordTransition(postedSteps.front().time, postedObservations.data(), static_cast<int32_t>(repliedChoice.to_ulong()), postedSteps.front().reward, false);
+    }
+    // both keep their capacity, only few steps are ever in flight
+    postedSteps.erase(postedSteps.begin());
+    postedObservations.erase(postedObservations.begin(), postedObservations.begin() + currentObservation.size());
+}
+
+void GymSplitter::sendBatched(BaseFrame1609_4* wsm, const veinsgym::proto::Space* action) {
+    Enter_Method_Silent();
+    heldPackets.erase(wsm);
+    const Interfaces allInterfaces = {Interface::dsrc, Interface::vlc_head, Interface::vlc_tail};
+    const auto choice = action ? Interfaces(action->discrete().value()) : fallbackChoice(allInterfaces);
+    recordTransition(static_cast<int32_t>(choice.to_ulong()), false);
+    sendWithChoice(wsm, choice);
+}
+
+void GymSplitter::sendWithChoice(BaseFrame1609_4* wsm, Interfaces choice) {
+    std::unique_ptr<BaseFrame1609_4> packet(wsm);
+    EV_INFO << "Using the following access technologies: " << choice.to_string() << " \n";
+    trackSent(packet.get(), choice);
+    sendViaInterfaces(packet.get(), choice);
+}
+
+void GymSplitter::trackSent(cPacket* packet, Interfaces choice) {
+    if (gymCon) {
+        // the costs are known right away, the success is credited once the packet arrived or timed out
+        deliveries->sent(packet->getTreeId(), choice);
+        unsettledIds.push_back(packet->getTreeId());
+        accumulatedReward -= dsrc_cost * choice.test(Interface::dsrc) + vlc_cost * (choice.test(Interface::vlc_head) + choice.test(Interface::vlc_tail));
+    }
+    lastChoice = choice;
+    lastSentId = packet->getTreeId();
+}
+
+void GymSplitter::finish() {
+    if (gymCon) {
+        gymCon->cancelSteps(mobility->getExternalId());
+        for (auto* wsm : heldPackets) {
+            delete wsm; // its step will never be answered
+        }
+        heldPackets.clear();
+        if (decided) {
+            accumulatedReward += collectRewards(leaderId, 0); // whatever did not arrive by now never will
+            recordTransition(-1, true); // the episode ends with this vehicle
+        }
+        recordScalar("agentDecisions", decisions);
+        recordScalar("repeatedChoices", repeatedChoices);
+    }
+    Splitter::finish();
+}
+
+GymSplitter::SnapshotState GymSplitter::saveSnapshotState() const {
+    SnapshotState state{lastSentId, unsettledIds, lastChoice, {headlightPacketsSent, taillightPacketsSent, vlcPacketsSent, headlightPacketsReceived, taillightPacketsReceived, vlcPacketsReceived}, accumulatedReward, beaconsSinceDecision,
+        decided, decisionRequested, leaderId, currentObservation, decisionObservation, decisionReward, {}};
+    for (const auto& feature : features) {
+        state.featureStates.push_back(feature->saveState());
+    }
+    return state;
+}
+
+void GymSplitter::restoreSnapshotState(const SnapshotState& state) {
+    lastSentId = state.lastSentId;
+    unsettledIds = state.unsettledIds;
+    lastChoice = state.lastChoice;
+    headlightPacketsSent = state.packetCounts[0];
+    taillightPacketsSent = state.packetCounts[1];
+    vlcPacketsSent = state.packetCounts[2];
+    headlightPacketsReceived = state.packetCounts[3];
+    taillightPacketsReceived = state.packetCounts[4];
+    vlcPacketsReceived = state.packetCounts[5];
+    accumulatedReward = state.accumulatedReward;
+    beaconsSinceDecision = state.beaconsSinceDecision;
+    decided = state.decided;
+    decisionRequested = state.decisionRequested; // re-creating the leader requested one for the restored agents
+    leaderId = state.leaderId;
+    currentObservation = state.currentObservation;
+    decisionObservation = state.decisionObservation;
+    decisionReward = state.decisionReward;
+    for (size_t i = 0; i < features.size(); ++i) {
+        features[i]->restoreState(state.featureStates.at(i));
+    }
+}
+
 void GymSplitter::handleLowerMessage(cMessage* msg) {
-    lastReceivedId = msg->getTreeId();
+    if (deliveries) {
+        const auto gate = msg->getArrivalGateId();
+        const auto interface = gate == fromVlcHead ? Interface::vlc_head : gate == fromVlcTail ? Interface::vlc_tail : Interface::dsrc;
+        deliveries->received(msg->getTreeId(), mobility->getExternalId(), interface);
+    }
     return Splitter::handleLowerMessage(msg);
 }
 
-double GymSplitter::computeReward(const GymSplitter* leaderSplitter) const {
-    const bool lastSuccessful = lastSentId > 0 && lastSentId == leaderSplitter->getLastReceivedId(); // test assumes: beacon interval >> E2E latency
-    const auto transmission_reward = success_reward * lastSuccessful;
-    const auto dsrc_penalty = dsrc_cost * lastChoice.test(Interface::dsrc);
-    const auto vlc_head_penalty = vlc_cost * lastChoice.test(Interface::vlc_head);
-    const auto vlc_tail_penalty = vlc_cost * lastChoice.test(Interface::vlc_tail);
-    const auto transmission_penalty = dsrc_penalty + vlc_head_penalty + vlc_tail_penalty;
-    return transmission_reward - transmission_penalty;
-}
-
-std::array<double, 4> GymSplitter::computeObservation(const TraCIMobility* leaderMobility) const {
-    // So far uses an oracle for simplicity
-    // Alternative: base on received beacons, included information age
-    const auto leaderPosition = leaderMobility->getPositionAt(simTime());
-    const auto leaderHeading = leaderMobility->getHeading().getRad();
-    const auto followerPosition = mobility->getPositionAt(simTime());
-    const auto followerHeading = mobility->getHeading().getRad();
-    const auto txVec = (leaderPosition - followerPosition).rotatedYaw(followerHeading);
-    const auto rxVec = (followerPosition - leaderPosition).rotatedYaw(leaderHeading);
-    return {
-        // scale and clip range to normalize observation values
-        std::max(-1.0, std::min(static_cast<double>(txVec.x / max_range), 1.0)),
-        std::max(-1.0, std::min(static_cast<double>(txVec.y / max_range), 1.0)),
-        rxVec.x/rxVec.length(),
-        rxVec.y/rxVec.length()
-    };
-}
-
-veinsgym::proto::Request GymSplitter::serializeObservation(const std::array<double, 4> &observation, const double reward) const {
-    veinsgym::proto::Request request;
-    request.set_id(1);
-    auto *values = request.mutable_step()->mutable_observation()->mutable_box()->mutable_values();
-    *values = {observation.begin(), observation.end()};
-    request.mutable_step()->mutable_reward()->mutable_box()->mutable_values()->Add();
-    request.mutable_step()->mutable_reward()->mutable_box()->set_values(0, reward);
-    return request;
+double GymSplitter::collectRewards(const std::string& leaderId, omnetpp::simtime_t timeout) {
+    return success_reward * deliveries->settle(unsettledIds, leaderId, timeout);
+}
+
+void GymSplitter::extractObservation(const GymConnection::Vehicle& leader) {
+    const ObservationContext context{mobility, leader, *gymCon};
+    double* out = currentObservation.data();
+    for (auto& feature : features) {
+        feature->extract(context, out);
+        out += feature->size();
+    }
+    observationFresh = true;
+}
+
+bool GymSplitter::decisionDue(const GymConnection::Vehicle& leader) {
+    // rewards of beacons sent with a repeated choice are credited to the next decision
+    leaderId = leader.mobility->getExternalId();
+    accumulatedReward += collectRewards(leaderId, deliveryTimeout);
+    ++beaconsSinceDecision;
+    observationFresh = false;
+
+    bool due = !decided || decisionRequested || (decisionInterval > 0 && beaconsSinceDecision >= decisionInterval);
+    if (!due && observationThreshold >= 0) {
+        // only the threshold needs the observation of beacons that may not end up as steps
+        extractObservation(leader);
+        for (size_t i = 0; i < currentObservation.size(); ++i) {
+            due = due || std::abs(currentObservation[i] - decisionObservation[i]) > observationThreshold;
+        }
+    }
+    if (!due) {
+        ++repeatedChoices;
+    }
+    return due;
+}
+
+void GymSplitter::computeStep(const GymConnection::Vehicle& leader, veinsgym::proto::Step* step) {
+    if (!observationFresh) {
+        extractObservation(leader);
+    }
+    serializeObservation(currentObservation, accumulatedReward, step);
+    decisionObservation = currentObservation;
+    decisionReward = accumulatedReward;
+    accumulatedReward = 0;
+    beaconsSinceDecision = 0;
+    decided = true;
+    decisionRequested = false;
+    ++decisions;
+}
+
+void GymSplitter::serializeObservation(const std::vector<double> &observation, const double reward, veinsgym::proto::Step* step) const {
+    // write into the fields in place, they keep their capacity when the step message is reused
+    auto *values = step->mutable_observation()->mutable_box()->mutable_values();
+    values->Clear();
+    values->Reserve(observation.size());
+    for (const auto value : observation) {
+        values->AddAlreadyReserved(value);
+    }
+    auto *rewards = step->mutable_reward()->mutable_box()->mutable_values();
+    rewards->Clear();
+    rewards->Add(reward);
+}
+
+void GymSplitter::recordTransition(int32_t action, bool done) {
+    // terminal rows carry the reward collected since the last decision
+    recordTransition(simTime(), currentObservation.data(), action, done ? accumulatedReward : decisionReward, done);
+}
+
+void GymSplitter::recordTransition(omnetpp::simtime_t time, const double* observation, int32_t action, double reward, bool done) {
+    if (auto recorder = gymCon->getRecorder(currentObservation.size())) {
+        recorder->record(time.dbl(), observation, action, reward, done, leaderId, mobility->getExternalId());
+    }
+}
+
+GymSplitter::Interfaces GymSplitter::fallbackChoice(Interfaces defaultChoice) const {
+    if (fallbackAction >= 0) {
+        return Interfaces(fallbackAction);
+    }
+    return lastSentId >= 0 ? lastChoice : defaultChoice;
+}
+
+const GymConnection::Vehicle* GymSplitter::findLeader() const {
+    const auto leader = gymCon ? gymCon->getLeader() : nullptr;
+    return leader && leader->splitter ? leader : nullptr;
 }
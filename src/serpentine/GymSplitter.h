@@ -19,18 +19,44 @@
 #pragma once
 
 #include "veins-vlc/Splitter.h"
+#include "serpentine/DeliveryTracker.h"
 #include "serpentine/GymConnection.h"
+#include "serpentine/ObservationFeature.h"
 
 #include <array>
 #include <memory>
+#include <set>
+#include <string>
+#include <vector>
 
 class GymSplitter : public veins::Splitter {
 public:
     GymSplitter() = default;
     virtual ~GymSplitter();
     void initialize() override;
+    void finish() override;
+    void handleUpperMessage(cMessage* msg) override;
     void handleLowerMessage(cMessage* msg) override;
-    long getLastReceivedId() const { return lastReceivedId; }
+    void requestDecision() { decisionRequested = true; } // query the agent on the next beacon, regardless of the decision interval, e.g., once the leader changed
+
+    // state carried across steps, captured in snapshots of the simulation
+    struct SnapshotState {
+        long lastSentId;
+        std::vector<long> unsettledIds;
+        Interfaces lastChoice;
+        std::array<int, 6> packetCounts; // sent and received via headlight, taillight, and VLC overall
+        double accumulatedReward;
+        int beaconsSinceDecision;
+        bool decided;
+        bool decisionRequested;
+        std::string leaderId;
+        std::vector<double> currentObservation;
+        std::vector<double> decisionObservation;
+        double decisionReward;
+        std::vector<std::vector<double>> featureStates; // in the order of GymConnection.observationFeatures
+    };
+    SnapshotState saveSnapshotState() const;
+    void restoreSnapshotState(const SnapshotState& state);
 
 protected:
     Interfaces getAccessTechnology(cPacket *msg) override;
@@ -40,15 +66,54 @@ private:
     double success_reward;
     double dsrc_cost;
     double vlc_cost;
-    double max_range;
+    int fallbackAction;
+    int decisionInterval;
+    double observationThreshold;
 
-    double computeReward(const GymSplitter* leaderSplitter) const;
-    std::array<double, 4> computeObservation(const TraCIMobility* leaderMobility) const;
-    veinsgym::proto::Request serializeObservation(const std::array<double, 4> &observation, double reward) const;
+    double collectRewards(const std::string& leaderId, omnetpp::simtime_t timeout);
+    void extractObservation(const GymConnection::Vehicle& leader);
+    void serializeObservation(const std::vector<double> &observation, double reward, veinsgym::proto::Step* step) const;
+    bool decisionDue(const GymConnection::Vehicle& leader);
+    void computeStep(const GymConnection::Vehicle& leader, veinsgym::proto::Step* step);
+    Interfaces fallbackChoice(Interfaces defaultChoice) const;
+    const GymConnection::Vehicle* findLeader() const;
+    void sendBatched(BaseFrame1609_4* wsm, const veinsgym::proto::Space* action);
+    void sendWithChoice(BaseFrame1609_4* wsm, Interfaces choice);
+    void trackSent(cPacket* packet, Interfaces choice);
+    void postStep(const veinsgym::proto::Request& request);
+    void answerPosted(const veinsgym::proto::Space* action);
+    void recordTransition(int32_t action, bool done);
+    void recordTransition(omnetpp::simtime_t time, const double* observation, int32_t action, double reward, bool done);
 
     bool isFollower = false;
-    // Problem: Erste transmission
+    DeliveryTracker* deliveries = nullptr; // shared by all vehicles, owned by the GymConnection
     long lastSentId = -1;
-    long lastReceivedId = -2;
+    std::vector<long> unsettledIds; // sent packets the agent has not been rewarded for yet
+    omnetpp::simtime_t deliveryTimeout;
     Interfaces lastChoice = {};
+    std::set<BaseFrame1609_4*> heldPackets; // waiting for their batched step, deleted if it gets cancelled
+
+    // async mode: steps posted to the agent, recorded once their reply arrives
+    struct PostedStep {
+        omnetpp::simtime_t time;
+        double reward;
+    };
+    std::vector<PostedStep> postedSteps; // not answered yet, oldest first
+    std::vector<double> postedObservations; // of postedSteps, back to back
+    bool replyWaiting = false; // a reply arrived since the last decision, repliedChoice holds its action
+    Interfaces repliedChoice = {};
+
+    // decision control, beacons in between decisions repeat lastChoice
+    std::vector<std::unique_ptr<ObservationFeature>> features;
+    std::vector<double> currentObservation; // sized once, features write their values in place
+    std::vector<double> decisionObservation;
+    bool observationFresh = false; // currentObservation reflects this beacon
+    double accumulatedReward = 0;
+    double decisionReward = 0; // reward sent with the last decision
+    std::string leaderId;
+    int beaconsSinceDecision = 0;
+    bool decided = false;
+    bool decisionRequested = false;
+    long decisions = 0;
+    long repeatedChoices = 0;
 };
@@ -0,0 +1,182 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "serpentine/ObservationFeature.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "veins/base/utils/FindModule.h"
+#include "veins/modules/mac/ieee80211p/Mac1609_4.h"
+#include "veins/modules/mobility/traci/TraCIMobility.h"
+#include "serpentine/GymSplitter.h"
+#include "serpentine/SerpentineApp.h"
+
+Register_Class(RelativePositionFeature);
+Register_Class(ReverseDirectionFeature);
+Register_Class(SpeedFeature);
+Register_Class(NeighbourCountFeature);
+Register_Class(ChannelBusyRatioFeature);
+Register_Class(BeliefRelativePositionFeature);
+Register_Class(BeliefReverseDirectionFeature);
+Register_Class(BeaconAgeFeature);
+
+void RelativePositionFeature::initialize(GymSplitter* splitter)
+{
+    maxRange = splitter->par("maxRange");
+}
+
+void RelativePositionFeature::extract(const ObservationContext& context, double* out)
+{
+    // uses an oracle for simplicity, see BeliefRelativePositionFeature for the beacon-based variant
+    const auto now = omnetpp::simTime();
+    const auto txVec = (context.leader.mobility->getPositionAt(now) - context.mobility->getPositionAt(now)).rotatedYaw(context.mobility->getHeading().getRad());
+    out[0] = std::max(-1.0, std::min(static_cast<double>(txVec.x / maxRange), 1.0));
+    out[1] = std::max(-1.0, std::min(static_cast<double>(txVec.y / maxRange), 1.0));
+}
+
+void ReverseDirectionFeature::extract(const ObservationContext& context, double* out)
+{
+    const auto now = omnetpp::simTime();
+    const auto rxVec = (context.mobility->getPositionAt(now) - context.leader.mobility->getPositionAt(now)).rotatedYaw(context.leader.mobility->getHeading().getRad());
+    out[0] = rxVec.x / rxVec.length();
+    out[1] = rxVec.y / rxVec.length();
+}
+
+std::pair<double, double> SpeedFeature::bounds(size_t index) const
+{
+    return {0, std::numeric_limits<double>::infinity()};
+}
+
+void SpeedFeature::extract(const ObservationContext& context, double* out)
+{
+    out[0] = context.mobility->getSpeed();
+    out[1] = context.leader.mobility->getSpeed();
+}
+
+void NeighbourCountFeature::initialize(GymSplitter* splitter)
+{
+    maxRange = splitter->par("maxRange");
+}
+
+std::pair<double, double> NeighbourCountFeature::bounds(size_t index) const
+{
+    return {0, std::numeric_limits<double>::infinity()};
+}
+
+void NeighbourCountFeature::extract(const ObservationContext& context, double* out)
+{
+    const auto now = omnetpp::simTime();
+    const auto position = context.mobility->getPositionAt(now);
+    size_t neighbours = 0;
+    for (const auto& vehicle : context.connection.getVehicles()) {
+        if (vehicle.second.mobility != context.mobility && vehicle.second.mobility->getPositionAt(now).distance(position) <= maxRange) {
+            ++neighbours;
+        }
+    }
+    out[0] = neighbours;
+}
+
+void ChannelBusyRatioFeature::initialize(GymSplitter* splitter)
+{
+    const auto macs = veins::getSubmodulesOfType<veins::Mac1609_4>(splitter->getParentModule(), true);
+    if (macs.empty()) {
+        throw omnetpp::cRuntimeError("ChannelBusyRatioFeature needs a Mac1609_4 in the vehicle");
+    }
+    mac = macs.front();
+    lastTime = omnetpp::simTime();
+    lastBusyTime = mac->getTotalBusyTime();
+}
+
+void ChannelBusyRatioFeature::extract(const ObservationContext& context, double* out)
+{
+    const auto now = omnetpp::simTime();
+    const auto busyTime = mac->getTotalBusyTime();
+    out[0] = now > lastTime ? (busyTime - lastBusyTime) / (now - lastTime) : 0.0;
+    lastTime = now;
+    lastBusyTime = busyTime;
+}
+
+std::vector<double> ChannelBusyRatioFeature::saveState() const
+{
+    // the MAC of a restored vehicle counts its busy time from zero again, so keep what accrued since the last extraction
+    return {(omnetpp::simTime() - lastTime).dbl(), (mac->getTotalBusyTime() - lastBusyTime).dbl()};
+}
+
+void ChannelBusyRatioFeature::restoreState(const std::vector<double>& state)
+{
+    lastTime = omnetpp::simTime() - state.at(0);
+    lastBusyTime = mac->getTotalBusyTime() - state.at(1);
+}
+
+void BeliefFeature::initialize(GymSplitter* splitter)
+{
+    const auto apps = veins::getSubmodulesOfType<veins::serpentine::SerpentineApp>(splitter->getParentModule());
+    if (apps.empty()) {
+        throw omnetpp::cRuntimeError("Belief features need a SerpentineApp in the vehicle");
+    }
+    app = apps.front();
+}
+
+const veins::serpentine::BeaconHistory* BeliefFeature::leaderBeacons(const ObservationContext& context) const
+{
+    return app->getBeacons(context.leader.mobility->getExternalId());
+}
+
+void BeliefRelativePositionFeature::initialize(GymSplitter* splitter)
+{
+    BeliefFeature::initialize(splitter);
+    maxRange = splitter->par("maxRange");
+}
+
+void BeliefRelativePositionFeature::extract(const ObservationContext& context, double* out)
+{
+    const auto beacons = leaderBeacons(context);
+    if (!beacons) {
+        out[0] = out[1] = 0;
+        return;
+    }
+    const auto now = omnetpp::simTime();
+    const auto txVec = (beacons->positionAt(now) - context.mobility->getPositionAt(now)).rotatedYaw(context.mobility->getHeading().getRad());
+    out[0] = std::max(-1.0, std::min(static_cast<double>(txVec.x / maxRange), 1.0));
+    out[1] = std::max(-1.0, std::min(static_cast<double>(txVec.y / maxRange), 1.0));
+}
+
+void BeliefReverseDirectionFeature::extract(const ObservationContext& context, double* out)
+{
+    const auto beacons = leaderBeacons(context);
+    if (!beacons) {
+        out[0] = out[1] = 0;
+        return;
+    }
+    const auto now = omnetpp::simTime();
+    const auto rxVec = (context.mobility->getPositionAt(now) - beacons->positionAt(now)).rotatedYaw(beacons->latest().heading);
+    const auto length = rxVec.length();
+    out[0] = length > 0 ? rxVec.x / length : 0;
+    out[1] = length > 0 ? rxVec.y / length : 0;
+}
+
+void BeaconAgeFeature::extract(const ObservationContext& context, double* out)
+{
+    const auto beacons = leaderBeacons(context);
+    out[0] = beacons ? std::min(1.0, (omnetpp::simTime() - beacons->latest().time) / app->getBeliefTimeout()) : 1.0;
+}
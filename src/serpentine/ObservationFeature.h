@@ -0,0 +1,160 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <omnetpp.h>
+#include "serpentine/GymConnection.h"
+
+namespace veins {
+class Mac1609_4;
+namespace serpentine {
+class BeaconHistory;
+class SerpentineApp;
+} // namespace serpentine
+} // namespace veins
+class GymSplitter;
+
+// what a feature may look at when writing its part of an observation
+struct ObservationContext {
+    const veins::TraCIMobility* mobility; // of the learning vehicle
+    const GymConnection::Vehicle& leader;
+    const GymConnection& connection;
+};
+
+/**
+ * Extracts a fixed number of observation values for a learning vehicle.
+ *
+ * Features are registered with Register_Class and picked by class name via GymConnection.observationFeatures.
+ * Every GymSplitter owns its own instances, so features may keep state between extractions.
+ * size() and bounds() must not depend on initialize(), as GymConnection derives the observation space from fresh instances.
+ */
+class ObservationFeature : public omnetpp::cObject {
+public:
+    virtual void initialize(GymSplitter* splitter) {} // look up modules and parameters once
+    virtual size_t size() const = 0;
+    virtual std::pair<double, double> bounds(size_t index) const = 0; // low and high of a value, may be infinite
+    virtual void extract(const ObservationContext& context, double* out) = 0; // writes size() values
+
+    // state kept between extractions, for snapshots of the simulation, times relative to the current simulation time
+    virtual std::vector<double> saveState() const { return {}; }
+    virtual void restoreState(const std::vector<double>& state) {}
+};
+
+// leader position in the frame of the learning vehicle, scaled by maxRange and clipped to [-1, 1]
+class RelativePositionFeature : public ObservationFeature {
+public:
+    void initialize(GymSplitter* splitter) override;
+    size_t size() const override { return 2; }
+    std::pair<double, double> bounds(size_t index) const override { return {-1, 1}; }
+    void extract(const ObservationContext& context, double* out) override;
+
+private:
+    double maxRange = 1;
+};
+
+// direction towards the learning vehicle in the frame of the leader, as a unit vector
+class ReverseDirectionFeature : public ObservationFeature {
+public:
+    size_t size() const override { return 2; }
+    std::pair<double, double> bounds(size_t index) const override { return {-1, 1}; }
+    void extract(const ObservationContext& context, double* out) override;
+};
+
+// speeds of the learning vehicle and the leader in m/s
+class SpeedFeature : public ObservationFeature {
+public:
+    size_t size() const override { return 2; }
+    std::pair<double, double> bounds(size_t index) const override;
+    void extract(const ObservationContext& context, double* out) override;
+};
+
+// number of other managed vehicles within maxRange of the learning vehicle
+class NeighbourCountFeature : public ObservationFeature {
+public:
+    void initialize(GymSplitter* splitter) override;
+    size_t size() const override { return 1; }
+    std::pair<double, double> bounds(size_t index) const override;
+    void extract(const ObservationContext& context, double* out) override;
+
+private:
+    double maxRange = 1;
+};
+
+// fraction of time the DSRC channel was sensed busy since the previous extraction
+class ChannelBusyRatioFeature : public ObservationFeature {
+public:
+    void initialize(GymSplitter* splitter) override;
+    size_t size() const override { return 1; }
+    std::pair<double, double> bounds(size_t index) const override { return {0, 1}; }
+    void extract(const ObservationContext& context, double* out) override;
+    std::vector<double> saveState() const override;
+    void restoreState(const std::vector<double>& state) override;
+
+private:
+    const veins::Mac1609_4* mac = nullptr;
+    omnetpp::simtime_t lastTime;
+    omnetpp::simtime_t lastBusyTime;
+};
+
+// base of features that rely on what the learning vehicle received from the leader's beacons instead of an oracle
+class BeliefFeature : public ObservationFeature {
+public:
+    void initialize(GymSplitter* splitter) override;
+
+protected:
+    const veins::serpentine::BeaconHistory* leaderBeacons(const ObservationContext& context) const; // nullptr while the leader is unknown
+
+    const veins::serpentine::SerpentineApp* app = nullptr;
+};
+
+// like RelativePositionFeature, but with the leader position extrapolated from its latest beacon (zero while unknown)
+class BeliefRelativePositionFeature : public BeliefFeature {
+public:
+    void initialize(GymSplitter* splitter) override;
+    size_t size() const override { return 2; }
+    std::pair<double, double> bounds(size_t index) const override { return {-1, 1}; }
+    void extract(const ObservationContext& context, double* out) override;
+
+private:
+    double maxRange = 1;
+};
+
+// like ReverseDirectionFeature, but in the frame the leader announced in its latest beacon (zero while unknown)
+class BeliefReverseDirectionFeature : public BeliefFeature {
+public:
+    size_t size() const override { return 2; }
+    std::pair<double, double> bounds(size_t index) const override { return {-1, 1}; }
+    void extract(const ObservationContext& context, double* out) override;
+};
+
+// age of the leader's latest beacon relative to the belief timeout, 1 while unknown
+class BeaconAgeFeature : public BeliefFeature {
+public:
+    size_t size() const override { return 1; }
+    std::pair<double, double> bounds(size_t index) const override { return {0, 1}; }
+    void extract(const ObservationContext& context, double* out) override;
+};
@@ -0,0 +1,71 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <google/protobuf/message_lite.h>
+#include <zmq/zmq.hpp>
+
+/**
+ * Buffers of requests that ZMQ sends without copying them.
+ *
+ * Each request gets a buffer of its own, as a DEALER socket may still queue earlier ones.
+ * A buffer stays in use until the reply to its request arrived, replies arrive in the order of the requests.
+ * Buffers keep their capacity, so once the pool holds as many as requests are in flight, sending allocates nothing:
+ * the messages do not own their data, which keeps libzmq from allocating a reference count for them.
+ */
+class SendBufferPool {
+public:
+    zmq::message_t serialize(const google::protobuf::MessageLite& message)
+    {
+        if (used == buffers.size()) {
+            buffers.emplace_back();
+        }
+        auto& buffer = buffers[used++];
+        const size_t size = message.ByteSizeLong();
+        buffer.resize(size);
+        message.SerializeWithCachedSizesToArray(buffer.data());
+        return zmq::message_t(buffer.data(), size, nullptr);
+    }
+
+    // the oldest request in use has been answered, its buffer may be reused
+    void release()
+    {
+        if (used > 0) {
+            std::rotate(buffers.begin(), buffers.begin() + 1, buffers.begin() + used);
+            --used;
+        }
+    }
+
+    size_t inUse() const
+    {
+        return used;
+    }
+
+private:
+    std::vector<std::vector<uint8_t>> buffers; // the first used ones in order of their requests
+    size_t used = 0;
+};
@@ -20,10 +20,13 @@
 
 #include "serpentine/SerpentineApp.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "veins/base/utils/FindModule.h"
 #include "veins/base/modules/BaseMobility.h"
 #include "veins/modules/mobility/traci/TraCIMobility.h"
-#include "veins/modules/messages/DemoSafetyMessage_m.h"
+#include "serpentine/SerpentineBeacon_m.h"
 #include "veins/modules/utility/Consts80211p.h"
 
 Define_Module(veins::serpentine::SerpentineApp);
@@ -38,19 +41,24 @@ void SerpentineApp::initialize(int stage)
 
     if (stage == 0) {
         // set up beaconing timer
-        auto triggerBeacon = [this]() { this->beacon(); };
-        auto timerSpec = TimerSpecification(triggerBeacon)
-            .relativeStart(uniform(0, par("beaconInterval")))
-            .interval(par("beaconInterval"));
-        timerManager.create(timerSpec);
+        beaconInterval = par("beaconInterval");
+        if (par("alignBeacons")) {
+            // start on the next multiple of the interval, so all vehicles decide in the same epoch
+            startBeacons(beaconInterval * ceil(simTime() / beaconInterval));
+        }
+        else {
+            startBeacons(simTime() + uniform(0, beaconInterval));
+        }
 
         // find mobility submodule
         auto mobilityModules = getSubmodulesOfType<TraCIMobility>(getParentModule());
         ASSERT(mobilityModules.size() == 1);
         mobility = mobilityModules.front();
+        beaconHistoryLength = std::max(1, par("beaconHistoryLength").intValue());
+        beliefTimeout = par("beliefTimeout");
 
         // determine leader/follower role
-        isFollower = mobilityModules.front()->getExternalId() == "follower";
+        isFollower = mobilityModules.front()->getExternalId().rfind("follower", 0) == 0; // "follower" or "follower.<n>"
         EV_INFO << "Initialized vehicle '" << mobilityModules.front()->getExternalId() << "' as " << (isFollower ? "Follower" : "Leader") << "\n";
     }
 }
@@ -59,6 +67,13 @@ void SerpentineApp::finish()
 {
 }
 
+void SerpentineApp::startBeacons(simtime_t first)
+{
+    auto triggerBeacon = [this]() { this->beacon(); };
+    beaconTimer = timerManager.create(TimerSpecification(triggerBeacon).interval(beaconInterval).absoluteStart(first));
+    nextBeacon = first;
+}
+
 void SerpentineApp::handleSelfMsg(cMessage* msg)
 {
     timerManager.handleMessage(msg);
@@ -66,26 +81,88 @@ void SerpentineApp::handleSelfMsg(cMessage* msg)
 
 void SerpentineApp::beacon()
 {
+    nextBeacon = simTime() + beaconInterval;
+
     // just some demo content
-    auto* dsm = new DemoSafetyMessage();
+    auto* dsm = new SerpentineBeacon();
 
     dsm->setRecipientAddress(LAddress::L2BROADCAST());
     dsm->setBitLength(par("headerLength").intValue());
+    dsm->setSenderTime(simTime());
     dsm->setSenderPos(mobility->getPositionAt(simTime()));
     dsm->setSenderSpeed(mobility->getCurrentSpeed());
+    dsm->setSenderId(mobility->getExternalId().c_str());
+    dsm->setSenderHeading(mobility->getHeading().getRad());
+    dsm->setSequenceNumber(beaconsSent++);
     dsm->setPsid(-1);
     dsm->setChannelNumber(static_cast<int>(Channel::cch));
     dsm->addBitLength(par("beaconLengthBits").intValue());
     dsm->setUserPriority(par("beaconUserPriority").intValue());
 
     sendDown(dsm);
+
+    forgetStaleNeighbours();
 }
 
 void SerpentineApp::handleLowerMsg(cMessage* msg)
 {
     EV_INFO << "Received beacon.\n";
+    if (auto beacon = dynamic_cast<SerpentineBeacon*>(msg)) {
+        auto history = beacons.find(beacon->getSenderId());
+        if (history == beacons.end()) {
+            history = beacons.emplace(beacon->getSenderId(), BeaconHistory(beaconHistoryLength)).first;
+        }
+        if (!history->second.add({beacon->getSenderTime(), beacon->getSenderPos(), beacon->getSenderSpeed(), beacon->getSenderHeading(), beacon->getSequenceNumber()})) {
+            EV_INFO << "Dropping beacon " << beacon->getSequenceNumber() << " of " << beacon->getSenderId() << ", it has been received before.\n";
+        }
+    }
     cancelAndDelete(msg);
 }
 
+void SerpentineApp::forgetStaleNeighbours()
+{
+    for (auto history = beacons.begin(); history != beacons.end();) {
+        if (simTime() - history->second.latest().time > beliefTimeout) {
+            history = beacons.erase(history);
+        }
+        else {
+            ++history;
+        }
+    }
+}
+
+const BeaconHistory* SerpentineApp::getBeacons(const std::string& senderId) const
+{
+    const auto history = beacons.find(senderId);
+    if (history == beacons.end() || simTime() - history->second.latest().time > beliefTimeout) {
+        return nullptr;
+    }
+    return &history->second;
+}
+
+SerpentineApp::SnapshotState SerpentineApp::saveSnapshotState() const
+{
+    SnapshotState state{beacons, beaconsSent, nextBeacon - simTime()};
+    for (auto& history : state.beacons) {
+        history.second.shift(-simTime());
+    }
+    return state;
+}
+
+void SerpentineApp::restoreSnapshotState(const SnapshotState& state)
+{
+    Enter_Method_Silent();
+    beacons = state.beacons;
+    for (auto& history : beacons) {
+        history.second.shift(simTime());
+    }
+    beaconsSent = state.beaconsSent; // neighbours would drop the lower sequence numbers of a fresh count as duplicates
+    if (!par("alignBeacons")) {
+        // aligned beacons already keep to the common grid
+        timerManager.cancel(beaconTimer);
+        startBeacons(simTime() + state.nextBeacon);
+    }
+}
+
 } // namespace serpentine
 } // namespace veins
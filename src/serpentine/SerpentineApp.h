@@ -20,17 +20,84 @@
 
 #pragma once
 
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
 #include "veins/veins.h"
 
 #include "veins/base/modules/BaseApplLayer.h"
+#include "veins/base/utils/Coord.h"
 #include "veins/modules/utility/TimerManager.h"
 
 namespace veins {
 
-class BaseMobility;
+class TraCIMobility;
 
 namespace serpentine {
 
+// beacons last received from one neighbour, the oldest entry gets overwritten
+class BeaconHistory {
+public:
+    struct Entry {
+        simtime_t time; // when the sender sampled position and velocity
+        Coord position;
+        Coord velocity;
+        double heading;
+        unsigned long sequenceNumber;
+    };
+
+    explicit BeaconHistory(size_t capacity)
+        : entries(capacity)
+    {
+    }
+
+    // copies of the latest beacon received over another interface, and older beacons arriving late, are dropped
+    bool add(const Entry& entry)
+    {
+        if (count > 0 && entry.sequenceNumber <= latest().sequenceNumber) {
+            return false;
+        }
+        entries[count++ % entries.size()] = entry;
+        return true;
+    }
+
+    size_t size() const
+    {
+        return std::min(count, entries.size());
+    }
+
+    // age 0 is the latest entry, size() - 1 the oldest
+    const Entry& at(size_t age) const
+    {
+        return entries[(count - 1 - age) % entries.size()];
+    }
+
+    const Entry& latest() const
+    {
+        return at(0);
+    }
+
+    // dead reckoning from the latest entry
+    Coord positionAt(simtime_t t) const
+    {
+        return latest().position + latest().velocity * (t - latest().time).dbl();
+    }
+
+    // moves all entries by offset in time, to keep their ages when carried over to another point in time
+    void shift(simtime_t offset)
+    {
+        for (auto& entry : entries) {
+            entry.time += offset;
+        }
+    }
+
+private:
+    std::vector<Entry> entries;
+    size_t count = 0;
+};
+
 class SerpentineApp : public BaseApplLayer {
 public:
     ~SerpentineApp() override = default;
@@ -44,12 +111,39 @@ public:
     void beacon();
     void handleLowerMsg(cMessage* msg) override;
 
+    // what this vehicle knows about a neighbour from its beacons, nullptr if nothing recent was received
+    const BeaconHistory* getBeacons(const std::string& senderId) const;
+    simtime_t getBeliefTimeout() const
+    {
+        return beliefTimeout;
+    }
+
+    // state carried across beacons, captured in snapshots of the simulation with times relative to when they were taken
+    struct SnapshotState {
+        std::map<std::string, BeaconHistory> beacons;
+        unsigned long beaconsSent;
+        simtime_t nextBeacon;
+    };
+    SnapshotState saveSnapshotState() const;
+    void restoreSnapshotState(const SnapshotState& state);
+
 protected:
+    void startBeacons(simtime_t first);
+    void forgetStaleNeighbours(); // drops the histories getBeacons() no longer reports, e.g., of vehicles that left
+
+
     TimerManager timerManager{this};
-    BaseMobility* mobility;
+    TraCIMobility* mobility;
 
 private:
     bool isFollower = false;
+    size_t beaconHistoryLength = 1;
+    simtime_t beliefTimeout;
+    std::map<std::string, BeaconHistory> beacons; // by sender id
+    unsigned long beaconsSent = 0;
+    simtime_t beaconInterval;
+    simtime_t nextBeacon;
+    TimerManager::TimerHandle beaconTimer;
 };
 
 } // namespace serpentine
@@ -0,0 +1,163 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "serpentine/ShmChannel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <omnetpp.h>
+
+namespace {
+
+// waiting for the agent: spin for a few checks, then yield for a short while, then sleep for intervals that double up to a cap
+const unsigned int spinChecks = 1000;
+const auto yieldPhase = std::chrono::microseconds(200);
+const auto minSleep = std::chrono::microseconds(10);
+const auto maxSleep = std::chrono::milliseconds(1);
+
+// waits until ready() holds or the timeout (negative: none) expires, without keeping a core busy once the agent takes longer
+template <typename Predicate>
+bool waitUntil(Predicate ready, long timeoutMs)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::milliseconds(timeoutMs);
+    std::chrono::steady_clock::duration sleep = minSleep;
+    for (unsigned int checks = 0; !ready(); ++checks) {
+        const auto now = std::chrono::steady_clock::now();
+        if (timeoutMs >= 0 && now >= deadline) {
+            return false;
+        }
+        if (checks < spinChecks) {
+            continue;
+        }
+        if (now - start < yieldPhase) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::this_thread::sleep_for(timeoutMs >= 0 ? std::min(sleep, deadline - now) : sleep);
+        sleep = std::min<std::chrono::steady_clock::duration>(2 * sleep, maxSleep);
+    }
+    return true;
+}
+
+} // namespace
+
+ShmChannel::ShmChannel(const std::string& name, uint32_t slotCount, uint32_t slotSize)
+    : name("/" + name)
+    , slotCount(slotCount)
+    , slotSize(slotSize)
+    , segmentSize(sizeof(Header) + 2 * static_cast<size_t>(slotCount) * slotSize)
+{
+    if (slotCount == 0 || slotSize <= sizeof(uint32_t)) {
+        throw omnetpp::cRuntimeError("Invalid shared memory ring geometry: %u slots of %u bytes", slotCount, slotSize);
+    }
+
+    // start from a fresh segment, a stale one may still be mapped by the agent of a crashed run
+    shm_unlink(this->name.c_str());
+    const int fd = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        throw omnetpp::cRuntimeError("Could not open shared memory segment '%s': %s", this->name.c_str(), strerror(errno));
+    }
+    if (ftruncate(fd, segmentSize) != 0) {
+        close(fd);
+        throw omnetpp::cRuntimeError("Could not size shared memory segment '%s': %s", this->name.c_str(), strerror(errno));
+    }
+    void* mapping = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw omnetpp::cRuntimeError("Could not map shared memory segment '%s': %s", this->name.c_str(), strerror(errno));
+    }
+
+    header = new (mapping) Header();
+    header->slotCount = slotCount;
+    header->slotSize = slotSize;
+    header->requests.head = 0;
+    header->requests.tail = 0;
+    header->replies.head = 0;
+    header->replies.tail = 0;
+    header->version = version;
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = magic; // written last, agents wait for it before attaching
+}
+
+ShmChannel::~ShmChannel()
+{
+    if (header) {
+        munmap(header, segmentSize);
+        shm_unlink(name.c_str());
+    }
+}
+
+uint8_t* ShmChannel::reserveRequest(size_t size, long timeoutMs)
+{
+    if (size > maxPayloadSize()) {
+        throw omnetpp::cRuntimeError("Request of %zu bytes exceeds shared memory slot payload of %zu bytes", size, maxPayloadSize());
+    }
+    const uint64_t head = header->requests.head.load(std::memory_order_relaxed);
+    const bool free = waitUntil([this, head]() { return head - header->requests.tail.load(std::memory_order_acquire) < slotCount; }, timeoutMs);
+    return free ? slot(false, head) + sizeof(uint32_t) : nullptr;
+}
+
+void ShmChannel::commitRequest(size_t size)
+{
+    const uint64_t head = header->requests.head.load(std::memory_order_relaxed);
+    const uint32_t length = static_cast<uint32_t>(size);
+    std::memcpy(slot(false, head), &length, sizeof(length));
+    header->requests.head.store(head + 1, std::memory_order_release);
+}
+
+bool ShmChannel::waitForReply(long timeoutMs)
+{
+    const uint64_t tail = header->replies.tail.load(std::memory_order_relaxed);
+    return waitUntil([this, tail]() { return header->replies.head.load(std::memory_order_acquire) != tail; }, timeoutMs);
+}
+
+std::pair<const uint8_t*, size_t> ShmChannel::peekReply() const
+{
+    const uint8_t* data = slot(true, header->replies.tail.load(std::memory_order_relaxed));
+    uint32_t length;
+    std::memcpy(&length, data, sizeof(length));
+    if (length > maxPayloadSize()) {
+        throw omnetpp::cRuntimeError("Corrupt reply of %u bytes in shared memory segment '%s'", length, name.c_str());
+    }
+    return {data + sizeof(uint32_t), length};
+}
+
+void ShmChannel::releaseReply()
+{
+    header->replies.tail.fetch_add(1, std::memory_order_release);
+}
+
+uint8_t* ShmChannel::slot(bool reply, uint64_t index) const
+{
+    auto* slots = reinterpret_cast<uint8_t*>(header) + sizeof(Header);
+    const size_t ring = reply ? slotCount : 0;
+    return slots + (ring + index % slotCount) * slotSize;
+}
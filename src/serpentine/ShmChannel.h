@@ -0,0 +1,94 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+/**
+ * Pair of single-producer/single-consumer ring buffers in POSIX shared memory.
+ *
+ * Lets GymConnection exchange serialized requests and replies with an agent on the same host without a socket hop.
+ * The simulation creates the segment /<name>, the agent maps it and checks magic and version.
+ * A segment left behind by a crashed run is unlinked first, so agents still attached to it cannot interfere.
+ *
+ * Layout: a Header, followed by slotCount request slots (simulation to agent) and slotCount reply slots (agent to simulation).
+ * Each slot is slotSize bytes: a uint32_t payload length followed by the payload (a serialized protobuf message).
+ * head and tail of each ring count messages and only ever grow, slot index is count % slotCount.
+ * Integers use host byte order.
+ */
+class ShmChannel {
+public:
+    static constexpr uint32_t magic = 0x48534756; // "VGSH"
+    static constexpr uint32_t version = 1;
+
+    struct Ring {
+        alignas(64) std::atomic<uint64_t> head; // messages written, advanced by the producer
+        alignas(64) std::atomic<uint64_t> tail; // messages consumed, advanced by the consumer
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t slotCount;
+        uint32_t slotSize;
+        Ring requests;
+        Ring replies;
+    };
+
+    ShmChannel(const std::string& name, uint32_t slotCount, uint32_t slotSize);
+    ~ShmChannel();
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+
+    const std::string& getName() const
+    {
+        return name;
+    }
+
+    size_t maxPayloadSize() const
+    {
+        return slotSize - sizeof(uint32_t);
+    }
+
+    // request ring, written by the simulation, waiting returns nullptr or false once timeoutMs (negative: none) expired
+    uint8_t* reserveRequest(size_t size, long timeoutMs);
+    void commitRequest(size_t size);
+
+    // reply ring, read by the simulation
+    bool waitForReply(long timeoutMs);
+    std::pair<const uint8_t*, size_t> peekReply() const;
+    void releaseReply();
+
+private:
+    uint8_t* slot(bool reply, uint64_t index) const;
+
+    std::string name;
+    uint32_t slotCount;
+    uint32_t slotSize;
+    size_t segmentSize;
+    Header* header = nullptr;
+};
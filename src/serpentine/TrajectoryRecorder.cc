@@ -0,0 +1,149 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "serpentine/TrajectoryRecorder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <omnetpp.h>
+
+constexpr uint32_t TrajectoryRecorder::magic;
+constexpr uint32_t TrajectoryRecorder::chunkMagic;
+constexpr uint32_t TrajectoryRecorder::version;
+constexpr size_t TrajectoryRecorder::idSize;
+
+namespace {
+
+void appendId(std::vector<char>& column, const std::string& id)
+{
+    const auto length = std::min(id.size(), TrajectoryRecorder::idSize);
+    column.insert(column.end(), id.begin(), id.begin() + length);
+    column.insert(column.end(), TrajectoryRecorder::idSize - length, '\0');
+}
+
+} // namespace
+
+TrajectoryRecorder::TrajectoryRecorder(const std::string& fileName, uint32_t observationSize, uint32_t chunkSize)
+    : fileName(fileName)
+    , observationSize(observationSize)
+    , chunkSize(std::max(chunkSize, 1u))
+{
+    // append to existing files of the same layout, start new ones with a header
+    FileHeader header = {magic, version, observationSize, idSize};
+    if (std::FILE* existing = std::fopen(fileName.c_str(), "rb")) {
+        FileHeader found = {};
+        const bool complete = std::fread(&found, sizeof(found), 1, existing) == 1;
+        std::fclose(existing);
+        if (!complete) {
+            throw omnetpp::cRuntimeError("Trajectory file '%s' has a truncated header", fileName.c_str());
+        }
+        if (std::memcmp(&found, &header, sizeof(header)) != 0) {
+            throw omnetpp::cRuntimeError("Trajectory file '%s' has a different layout, not appending to it", fileName.c_str());
+        }
+        file = std::fopen(fileName.c_str(), "ab");
+    }
+    else {
+        file = std::fopen(fileName.c_str(), "wb");
+        if (file && std::fwrite(&header, sizeof(header), 1, file) != 1) {
+            throw omnetpp::cRuntimeError("Could not write trajectory file '%s': %s", fileName.c_str(), std::strerror(errno));
+        }
+    }
+    if (!file) {
+        throw omnetpp::cRuntimeError("Could not open trajectory file '%s': %s", fileName.c_str(), std::strerror(errno));
+    }
+
+    times.reserve(this->chunkSize);
+    observations.reserve(this->chunkSize * observationSize);
+    rewards.reserve(this->chunkSize);
+    actions.reserve(this->chunkSize);
+    leaders.reserve(this->chunkSize * idSize);
+    followers.reserve(this->chunkSize * idSize);
+    dones.reserve(this->chunkSize);
+}
+
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+    // no exceptions from destructors, a failed final write only loses the last chunk
+    if (!times.empty()) {
+        try {
+            flush();
+        }
+        catch (const std::exception&) {
+        }
+    }
+    std::fclose(file);
+}
+
+void TrajectoryRecorder::record(double time, const double* observation, int32_t action, double reward, bool done, const std::string& leaderId, const std::string& followerId)
+{
+    times.push_back(time);
+    observations.insert(observations.end(), observation, observation + observationSize);
+    rewards.push_back(reward);
+    actions.push_back(action);
+    appendId(leaders, leaderId);
+    appendId(followers, followerId);
+    dones.push_back(done);
+    if (times.size() >= chunkSize) {
+        flush();
+    }
+}
+
+void TrajectoryRecorder::flush()
+{
+    if (times.empty()) {
+        return;
+    }
+    const size_t rows = times.size();
+    const size_t bytes = rows * (sizeof(double) * (2 + observationSize) + sizeof(int32_t) + 2 * idSize + sizeof(uint8_t));
+    const size_t padding = (8 - bytes % 8) % 8;
+    const ChunkHeader header = {chunkMagic, static_cast<uint32_t>(rows), bytes + padding};
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        throw omnetpp::cRuntimeError("Could not write trajectory file '%s': %s", fileName.c_str(), std::strerror(errno));
+    }
+    writeColumn(times);
+    writeColumn(observations);
+    writeColumn(rewards);
+    writeColumn(actions);
+    writeColumn(leaders);
+    writeColumn(followers);
+    writeColumn(dones);
+    writeColumn(std::vector<uint8_t>(padding, 0));
+    std::fflush(file);
+
+    times.clear();
+    observations.clear();
+    rewards.clear();
+    actions.clear();
+    leaders.clear();
+    followers.clear();
+    dones.clear();
+}
+
+template <typename T>
+void TrajectoryRecorder::writeColumn(const std::vector<T>& column)
+{
+    if (!column.empty() && std::fwrite(column.data(), sizeof(T), column.size(), file) != column.size()) {
+        throw omnetpp::cRuntimeError("Could not write trajectory file '%s': %s", fileName.c_str(), std::strerror(errno));
+    }
+}
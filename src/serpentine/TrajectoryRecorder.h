@@ -0,0 +1,97 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Append-only columnar file of agent transitions, for offline RL and behaviour cloning.
+ *
+ * The file starts with a FileHeader, followed by any number of chunks (files written by several runs are simply concatenated).
+ * Each chunk is a ChunkHeader followed by one column after the other, each holding rows values:
+ *
+ *     time        double                      simulation time of the step
+ *     observation double[observationSize]     as sent to the agent
+ *     reward      double                      reward sent along with the observation, i.e., for the previous action
+ *     action      int32_t                     choice of access technologies (bitset), -1 in rows that end an episode
+ *     leader      char[idSize]                vehicle ids, zero-padded
+ *     follower    char[idSize]
+ *     done        uint8_t                     1 if the episode ended with this row
+ *
+ * followed by zero padding to a multiple of 8 bytes, so all double columns are aligned when the file is memory-mapped.
+ * Integers and doubles use host byte order.
+ */
+class TrajectoryRecorder {
+public:
+    static constexpr uint32_t magic = 0x52545053; // "SPTR"
+    static constexpr uint32_t chunkMagic = 0x4b4e4843; // "CHNK"
+    static constexpr uint32_t version = 1;
+    static constexpr size_t idSize = 16;
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t observationSize;
+        uint32_t idSize;
+    };
+
+    struct ChunkHeader {
+        uint32_t magic;
+        uint32_t rows;
+        uint64_t bytes; // size of the columns including padding, to skip a chunk without decoding it
+    };
+
+    TrajectoryRecorder(const std::string& fileName, uint32_t observationSize, uint32_t chunkSize);
+    ~TrajectoryRecorder();
+    TrajectoryRecorder(const TrajectoryRecorder&) = delete;
+    TrajectoryRecorder& operator=(const TrajectoryRecorder&) = delete;
+
+    uint32_t getObservationSize() const
+    {
+        return observationSize;
+    }
+
+    void record(double time, const double* observation, int32_t action, double reward, bool done, const std::string& leaderId, const std::string& followerId);
+    void flush(); // writes the rows recorded so far as a chunk
+
+private:
+    template <typename T>
+    void writeColumn(const std::vector<T>& column);
+
+    std::string fileName;
+    std::FILE* file = nullptr;
+    uint32_t observationSize;
+    uint32_t chunkSize;
+
+    // columns of the chunk being recorded
+    std::vector<double> times;
+    std::vector<double> observations;
+    std::vector<double> rewards;
+    std::vector<int32_t> actions;
+    std::vector<char> leaders;
+    std::vector<char> followers;
+    std::vector<uint8_t> dones;
+};
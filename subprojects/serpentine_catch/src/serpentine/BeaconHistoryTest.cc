@@ -0,0 +1,97 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "catch2/catch.hpp"
+#include "serpentine/SerpentineApp.h"
+#include "testutils/Simulation.h"
+
+using namespace veins;
+using namespace veins::serpentine;
+using omnetpp::cNullEnvir;
+
+SCENARIO("Beacons received over several interfaces are kept once", "[beaconHistory]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr)); // sets up the simulation time scale
+
+    GIVEN("A history of three beacons holding beacon 0 of a neighbour")
+    {
+        BeaconHistory history(3);
+        REQUIRE(history.add({0.1, Coord(0, 0), Coord(10, 0), 0, 0}));
+
+        WHEN("Beacon 1 arrives over DSRC, the head light, and the tail light")
+        {
+            const bool dsrc = history.add({0.2, Coord(1, 0), Coord(10, 0), 0, 1});
+            const bool head = history.add({0.2, Coord(1, 0), Coord(10, 0), 0, 1});
+            const bool tail = history.add({0.2001, Coord(1, 0), Coord(10, 0), 0, 1});
+
+            THEN("Only the first copy is added")
+            {
+                REQUIRE(dsrc);
+                REQUIRE_FALSE(head);
+                REQUIRE_FALSE(tail);
+                REQUIRE(history.size() == 2);
+                REQUIRE(history.latest().sequenceNumber == 1);
+                REQUIRE(history.at(1).sequenceNumber == 0);
+            }
+        }
+
+        WHEN("Beacon 2 arrives before a late copy of beacon 1")
+        {
+            REQUIRE(history.add({0.3, Coord(2, 0), Coord(10, 0), 0, 2}));
+            const bool late = history.add({0.31, Coord(1, 0), Coord(10, 0), 0, 1});
+
+            THEN("The late copy does not replace the newer beacon")
+            {
+                REQUIRE_FALSE(late);
+                REQUIRE(history.size() == 2);
+                REQUIRE(history.latest().sequenceNumber == 2);
+            }
+        }
+    }
+}
+
+SCENARIO("Beacon histories keep their ages when shifted to another point in time", "[beaconHistory]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr));
+
+    GIVEN("A history with beacons received at 1 s and 2 s")
+    {
+        BeaconHistory history(2);
+        history.add({1, Coord(0, 0), Coord(10, 0), 0, 0});
+        history.add({2, Coord(10, 0), Coord(10, 0), 0, 1});
+        const auto expected = history.positionAt(2.5);
+
+        WHEN("It is saved relative to a snapshot at 2.5 s and restored at 7.5 s")
+        {
+            history.shift(-2.5);
+            history.shift(7.5);
+
+            THEN("Entries and dead reckoning are moved by 5 s")
+            {
+                REQUIRE(history.size() == 2);
+                REQUIRE(history.latest().time == simtime_t(7));
+                REQUIRE(history.at(1).time == simtime_t(6));
+                REQUIRE(history.positionAt(7.5) == expected);
+            }
+        }
+    }
+}
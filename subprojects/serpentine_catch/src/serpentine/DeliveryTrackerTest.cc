@@ -0,0 +1,168 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "serpentine/DeliveryTracker.h"
+#include "testutils/Simulation.h"
+
+using omnetpp::cNullEnvir;
+using Interface = DeliveryTracker::Interface;
+using Interfaces = DeliveryTracker::Interfaces;
+
+namespace {
+
+void advanceTo(double seconds)
+{
+    omnetpp::getSimulation()->setSimTime(seconds);
+}
+
+} // namespace
+
+SCENARIO("The delivery tracker records receptions of tracked packets", "[deliveryTracker]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr));
+    DeliveryTracker tracker;
+    const Interfaces both = Interfaces().set(Interface::dsrc).set(Interface::vlc_tail);
+
+    GIVEN("A packet sent via DSRC and the taillight")
+    {
+        tracker.sent(1, both);
+
+        WHEN("The leader receives it via VLC first, then via DSRC, and another vehicle receives an untracked packet")
+        {
+            advanceTo(0.01);
+            tracker.received(1, "leader", Interface::vlc_tail);
+            advanceTo(0.03);
+            tracker.received(1, "leader", Interface::dsrc);
+            tracker.received(2, "other", Interface::dsrc);
+
+            THEN("Both receptions are kept in order with their latencies")
+            {
+                const auto* delivery = tracker.find(1);
+                REQUIRE(delivery != nullptr);
+                REQUIRE(delivery->interfaces == both);
+                REQUIRE(delivery->firstReception("leader")->interface == Interface::vlc_tail);
+                REQUIRE(delivery->firstReception("leader")->latency == omnetpp::simtime_t(0.01));
+                REQUIRE(delivery->receivedVia("leader", Interface::dsrc));
+                REQUIRE_FALSE(delivery->receivedVia("leader", Interface::vlc_head));
+                REQUIRE(delivery->firstReception("other") == nullptr);
+                REQUIRE(tracker.find(2) == nullptr);
+                REQUIRE(tracker.size() == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("Packets are settled once they arrived or timed out", "[deliveryTracker]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr));
+    DeliveryTracker tracker;
+    const Interfaces dsrc = Interfaces().set(Interface::dsrc);
+
+    GIVEN("Three packets sent 0.1 s apart, with a timeout of 0.5 s")
+    {
+        std::vector<long> unsettled = {1, 2, 3};
+        for (long treeId : unsettled) {
+            advanceTo(0.1 * treeId);
+            tracker.sent(treeId, dsrc);
+        }
+        const omnetpp::simtime_t timeout = 0.5;
+
+        WHEN("Packet 2 arrives after the next beacon at 0.35 s")
+        {
+            advanceTo(0.35);
+            const int early = tracker.settle(unsettled, "leader", timeout);
+            advanceTo(0.4);
+            tracker.received(2, "leader", Interface::dsrc);
+            const int late = tracker.settle(unsettled, "leader", timeout);
+
+            THEN("It is credited at the beacon after its arrival, the others stay pending")
+            {
+                REQUIRE(early == 0);
+                REQUIRE(late == 1);
+                REQUIRE(unsettled == std::vector<long>{1, 3});
+                REQUIRE(tracker.find(2) == nullptr);
+            }
+
+            AND_WHEN("The timeout of packet 1 passes")
+            {
+                advanceTo(0.6);
+                const int timedOut = tracker.settle(unsettled, "leader", timeout);
+
+                THEN("It is settled as failed and forgotten")
+                {
+                    REQUIRE(timedOut == 0);
+                    REQUIRE(unsettled == std::vector<long>{3});
+                    REQUIRE(tracker.find(1) == nullptr);
+                    REQUIRE(tracker.size() == 1);
+                }
+            }
+        }
+
+        WHEN("Settling without a timeout at the end of the episode")
+        {
+            tracker.received(3, "leader", Interface::dsrc);
+            const int received = tracker.settle(unsettled, "leader", 0);
+
+            THEN("Everything is settled and only the arrived packet counts")
+            {
+                REQUIRE(received == 1);
+                REQUIRE(unsettled.empty());
+                REQUIRE(tracker.size() == 0);
+            }
+        }
+
+        WHEN("The tracker is captured in a snapshot at 0.35 s that gets restored at 10 s")
+        {
+            advanceTo(0.35);
+            DeliveryTracker snapshot = tracker;
+            snapshot.shift(-omnetpp::simTime());
+            advanceTo(10);
+            tracker = snapshot;
+            tracker.shift(omnetpp::simTime());
+            const int restored = tracker.settle(unsettled, "leader", timeout);
+            advanceTo(10.25);
+            const int timedOut = tracker.settle(unsettled, "leader", timeout);
+
+            THEN("The packets keep their ages and time out as if no time had passed in between")
+            {
+                REQUIRE(restored == 0);
+                REQUIRE(timedOut == 0);
+                REQUIRE(unsettled == std::vector<long>{2, 3});
+                REQUIRE(tracker.find(2)->sendTime == omnetpp::simtime_t(9.85));
+            }
+        }
+
+        WHEN("The tracker was cleared by a reset")
+        {
+            tracker.clear();
+
+            THEN("The unknown packets are dropped without credit")
+            {
+                REQUIRE(tracker.settle(unsettled, "leader", timeout) == 0);
+                REQUIRE(unsettled.empty());
+            }
+        }
+    }
+}
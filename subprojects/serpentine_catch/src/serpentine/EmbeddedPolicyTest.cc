@@ -0,0 +1,133 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "catch2/catch.hpp"
+#include "serpentine/EmbeddedPolicy.h"
+#include "testutils/Simulation.h"
+
+using omnetpp::cNullEnvir;
+
+namespace {
+
+// policy file in the working directory, removed again when the test is done
+class PolicyFile {
+public:
+    explicit PolicyFile(const std::string& contents)
+    {
+        std::ofstream(fileName) << "serpentine-policy 1\noutput discrete\n" << contents << "\n";
+    }
+    ~PolicyFile()
+    {
+        std::remove(fileName.c_str());
+    }
+
+    const std::string fileName = "embedded-policy-test.txt";
+};
+
+uint64_t discreteAction(EmbeddedPolicy& policy, double x, double y)
+{
+    veinsgym::proto::Request request;
+    request.set_id(1);
+    auto* values = request.mutable_step()->mutable_observation()->mutable_box()->mutable_values();
+    values->Add(x);
+    values->Add(y);
+    veinsgym::proto::Reply reply;
+    policy.answer(request, &reply);
+    return reply.action().discrete().value();
+}
+
+} // namespace
+
+SCENARIO("Embedded policies validate their lookup table when loading", "[embeddedPolicy]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr));
+
+    GIVEN("A valid 2x3 lookup table")
+    {
+        PolicyFile file("lut 2 2 3\nrange 0 1\nrange -1 1\n0 1 2\n3 4 5");
+        EmbeddedPolicy policy(file.fileName);
+
+        THEN("Observations select the nearest cell, clipped to the ranges")
+        {
+            REQUIRE(discreteAction(policy, 0, -1) == 0);
+            REQUIRE(discreteAction(policy, 0.2, 0.1) == 1);
+            REQUIRE(discreteAction(policy, 1, 1) == 5);
+            REQUIRE(discreteAction(policy, 7, -9) == 3);
+            REQUIRE(discreteAction(policy, -INFINITY, INFINITY) == 2);
+        }
+
+        THEN("NaN observations are rejected")
+        {
+            REQUIRE_THROWS_WITH(discreteAction(policy, 0.2, NAN), Catch::Contains("NaN"));
+        }
+    }
+
+    GIVEN("Two lookup tables")
+    {
+        PolicyFile file("lut 1 2\nrange 0 1\n0 1\nlut 1 2\nrange 0 1\n1 0");
+        THEN("Loading fails")
+        {
+            REQUIRE_THROWS_WITH(EmbeddedPolicy{file.fileName}, Catch::Contains("more than one lookup table"));
+        }
+    }
+
+    GIVEN("A lookup table without dimensions")
+    {
+        PolicyFile file("lut 0\n0");
+        THEN("Loading fails")
+        {
+            REQUIRE_THROWS_WITH(EmbeddedPolicy{file.fileName}, Catch::Contains("at least one dimension"));
+        }
+    }
+
+    GIVEN("A lookup table dimension without bins")
+    {
+        PolicyFile file("lut 2 2 0\nrange 0 1\nrange 0 1");
+        THEN("Loading fails")
+        {
+            REQUIRE_THROWS_WITH(EmbeddedPolicy{file.fileName}, Catch::Contains("has no bins"));
+        }
+    }
+
+    GIVEN("A lookup table range with low == high")
+    {
+        PolicyFile file("lut 1 2\nrange 1 1\n0 1");
+        THEN("Loading fails")
+        {
+            REQUIRE_THROWS_WITH(EmbeddedPolicy{file.fileName}, Catch::Contains("empty or infinite range"));
+        }
+    }
+
+    GIVEN("A lookup table holding a negative Discrete action")
+    {
+        PolicyFile file("lut 1 2\nrange 0 1\n0 -1");
+        THEN("Loading fails")
+        {
+            REQUIRE_THROWS_WITH(EmbeddedPolicy{file.fileName}, Catch::Contains("which is not a valid"));
+        }
+    }
+}
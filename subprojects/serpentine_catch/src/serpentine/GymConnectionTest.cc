@@ -0,0 +1,269 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "serpentine/GymConnection.h"
+
+namespace {
+
+// heap allocations of this thread while counting, by operator new and, with glibc, by malloc (which libzmq uses)
+thread_local bool countingAllocations = false;
+thread_local long allocations = 0;
+
+void noteAllocation()
+{
+    if (countingAllocations) {
+        ++allocations;
+    }
+}
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    noteAllocation();
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* memory, size_t size);
+
+void* malloc(size_t size)
+{
+    noteAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    noteAllocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* memory, size_t size)
+{
+    noteAllocation();
+    return __libc_realloc(memory, size);
+}
+}
+#endif
+
+namespace {
+
+veinsgym::proto::Request stepRequest(double value, size_t count)
+{
+    veinsgym::proto::Request request;
+    request.set_id(1);
+    auto* values = request.mutable_step()->mutable_observation()->mutable_box()->mutable_values();
+    for (size_t i = 0; i < count; ++i) {
+        values->Add(value + i);
+    }
+    return request;
+}
+
+} // namespace
+
+SCENARIO("Async requests stay intact while ZMQ still queues them", "[gymConnection]")
+{
+    GIVEN("A DEALER socket connected to a ROUTER that does not read yet")
+    {
+        zmq::context_t context(1);
+        zmq::socket_t router(context, zmq::socket_type::router);
+        router.bind("inproc://serpentine-catch");
+        zmq::socket_t dealer(context, zmq::socket_type::dealer);
+        dealer.connect("inproc://serpentine-catch");
+
+        WHEN("Sending two requests back to back, as GymConnection::post() does")
+        {
+            SendBufferPool buffers;
+            std::vector<std::string> sent;
+            for (double value : {1.0, 1000.0}) {
+                // the second request is larger, a shared buffer would be reallocated while the first is queued
+                auto request = stepRequest(value, value > 1 ? 4096 : 16);
+                sent.push_back(request.SerializeAsString());
+                dealer.send(zmq::message_t(), zmq::send_flags::sndmore);
+                dealer.send(buffers.serialize(request), zmq::send_flags::none);
+            }
+
+            THEN("The agent receives both as they were serialized")
+            {
+                for (const auto& expected : sent) {
+                    zmq::message_t identity;
+                    zmq::message_t delimiter;
+                    zmq::message_t payload;
+                    REQUIRE(router.recv(identity).has_value());
+                    REQUIRE(router.recv(delimiter).has_value());
+                    REQUIRE(delimiter.size() == 0);
+                    REQUIRE(router.recv(payload).has_value());
+                    REQUIRE(std::string(static_cast<const char*>(payload.data()), payload.size()) == expected);
+                }
+                REQUIRE(buffers.inUse() == 2);
+            }
+        }
+    }
+}
+
+namespace {
+
+google::protobuf::ArenaOptions arenaOptions(char* initialBlock, size_t size)
+{
+    google::protobuf::ArenaOptions options;
+    options.initial_block = initialBlock;
+    options.initial_block_size = size;
+    return options;
+}
+
+// the simulation side of a step, as GymConnection::stepRequest() and communicate() do it, agent gets the sockets of the agent
+class StepLoop {
+public:
+    StepLoop(zmq::socket_t& simulation, bool dealer)
+        : simulation(simulation)
+        , dealer(dealer)
+        , requestArena(arenaOptions(requestBlock.data(), requestBlock.size()))
+        , replyArena(arenaOptions(replyBlock.data(), replyBlock.size()))
+    {
+    }
+
+    void send(size_t observationSize)
+    {
+        requestArena.Reset();
+        auto* request = google::protobuf::Arena::CreateMessage<veinsgym::proto::Request>(&requestArena);
+        request->set_id(1);
+        auto* values = request->mutable_step()->mutable_observation()->mutable_box()->mutable_values();
+        values->Reserve(observationSize);
+        for (size_t i = 0; i < observationSize; ++i) {
+            values->AddAlreadyReserved(i);
+        }
+        request->mutable_step()->mutable_reward()->mutable_box()->mutable_values()->Add(1);
+        if (dealer) {
+            simulation.send(zmq::message_t(), zmq::send_flags::sndmore);
+        }
+        simulation.send(buffers.serialize(*request), zmq::send_flags::none);
+    }
+
+    int64_t receive()
+    {
+        replyArena.Reset();
+        auto* reply = google::protobuf::Arena::CreateMessage<veinsgym::proto::Reply>(&replyArena);
+        if (dealer) {
+            simulation.recv(receiveBuffer);
+        }
+        simulation.recv(receiveBuffer);
+        buffers.release();
+        reply->ParseFromArray(receiveBuffer.data(), receiveBuffer.size());
+        return reply->action().discrete().value();
+    }
+
+private:
+    zmq::socket_t& simulation;
+    bool dealer;
+    std::vector<char> requestBlock = std::vector<char>(16 * 1024);
+    std::vector<char> replyBlock = std::vector<char>(16 * 1024);
+    google::protobuf::Arena requestArena;
+    google::protobuf::Arena replyArena;
+    SendBufferPool buffers;
+    zmq::message_t receiveBuffer;
+};
+
+// answers every request with the same action from a buffer it does not own, so the reply needs no allocation either
+void answer(zmq::socket_t& agent, bool router, const std::string& reply)
+{
+    zmq::message_t frame;
+    if (router) {
+        zmq::message_t identity;
+        agent.recv(identity);
+        agent.recv(frame);
+        agent.send(identity, zmq::send_flags::sndmore);
+        agent.send(zmq::message_t(), zmq::send_flags::sndmore);
+    }
+    agent.recv(frame);
+    agent.send(zmq::message_t(const_cast<char*>(reply.data()), reply.size(), nullptr), zmq::send_flags::none);
+}
+
+} // namespace
+
+SCENARIO("Steps do not allocate once the buffers have grown", "[gymConnection]")
+{
+    veinsgym::proto::Reply prototype;
+    prototype.set_id(1);
+    prototype.mutable_action()->mutable_discrete()->set_value(5);
+    const std::string reply = prototype.SerializeAsString();
+
+    for (const bool dealer : {false, true}) {
+        GIVEN(dealer ? "A DEALER socket with two steps in flight" : "A REQ socket")
+        {
+            zmq::context_t context(1);
+            zmq::socket_t agent(context, dealer ? zmq::socket_type::router : zmq::socket_type::rep);
+            agent.bind("inproc://serpentine-catch-steps");
+            zmq::socket_t simulation(context, dealer ? zmq::socket_type::dealer : zmq::socket_type::req);
+            simulation.connect("inproc://serpentine-catch-steps");
+            StepLoop loop(simulation, dealer);
+            const int inFlight = dealer ? 2 : 1;
+
+            WHEN("Running steps after enough to warm up")
+            {
+                long counted = 0;
+                int64_t actions = 0;
+                for (int step = 0; step < 1000; ++step) {
+                    // only the simulation side counts, the agent stands in for another process
+                    // ZMQ pipes grow in chunks of 256 messages and then keep a spare one, so warm up for several chunks
+                    const bool warm = step >= 500;
+                    allocations = 0;
+                    for (int i = 0; i < inFlight; ++i) {
+                        countingAllocations = warm;
+                        loop.send(64);
+                        countingAllocations = false;
+                        answer(agent, dealer, reply);
+                    }
+                    for (int i = 0; i < inFlight; ++i) {
+                        countingAllocations = warm;
+                        actions += loop.receive();
+                        countingAllocations = false;
+                    }
+                    counted += allocations;
+                }
+
+                THEN("Sending requests and parsing replies allocate nothing")
+                {
+                    REQUIRE(actions == 5 * 1000 * inFlight);
+                    REQUIRE(counted == 0);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,124 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <new>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "catch2/catch.hpp"
+#include "serpentine/ShmChannel.h"
+
+SCENARIO("Shared memory channels never reuse a stale segment", "[shmChannel]")
+{
+    GIVEN("A segment left behind by a crashed run, which still holds an unread reply")
+    {
+        const int fd = shm_open("/serpentine-catch", O_CREAT | O_RDWR, 0600);
+        REQUIRE(fd >= 0);
+        REQUIRE(ftruncate(fd, sizeof(ShmChannel::Header)) == 0);
+        void* mapping = mmap(nullptr, sizeof(ShmChannel::Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        REQUIRE(mapping != MAP_FAILED);
+        auto* stale = new (mapping) ShmChannel::Header();
+        stale->replies.head = 5;
+
+        WHEN("A new channel with the same name is created")
+        {
+            ShmChannel channel("serpentine-catch", 2, 64);
+
+            THEN("It starts out empty and the stale mapping stays untouched")
+            {
+                REQUIRE_FALSE(channel.waitForReply(0));
+                REQUIRE(stale->replies.head == 5);
+            }
+        }
+        munmap(mapping, sizeof(ShmChannel::Header));
+    }
+}
+
+SCENARIO("Shared memory channels give up on an agent that does not respond", "[shmChannel]")
+{
+    GIVEN("A channel no agent attached to")
+    {
+        ShmChannel channel("serpentine-catch", 2, 64);
+
+        THEN("Waiting for a reply times out")
+        {
+            REQUIRE_FALSE(channel.waitForReply(10));
+        }
+
+        THEN("Waiting for a long time leaves the core mostly idle")
+        {
+            const std::clock_t cpuStart = std::clock();
+            REQUIRE_FALSE(channel.waitForReply(200));
+            const double cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+            REQUIRE(cpuSeconds < 0.1);
+        }
+
+        THEN("Requests can be written until the ring is full, then reserving times out")
+        {
+            for (int i = 0; i < 2; ++i) {
+                REQUIRE(channel.reserveRequest(8, 10) != nullptr);
+                channel.commitRequest(8);
+            }
+            REQUIRE(channel.reserveRequest(8, 10) == nullptr);
+        }
+    }
+}
+
+SCENARIO("Shared memory channels still notice replies after backing off", "[shmChannel]")
+{
+    GIVEN("A channel and an agent that replies after 50 ms")
+    {
+        ShmChannel channel("serpentine-catch", 2, 64);
+        const int fd = shm_open("/serpentine-catch", O_RDWR, 0600);
+        REQUIRE(fd >= 0);
+        void* mapping = mmap(nullptr, sizeof(ShmChannel::Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        REQUIRE(mapping != MAP_FAILED);
+        auto* header = static_cast<ShmChannel::Header*>(mapping);
+
+        WHEN("Waiting for the reply")
+        {
+            const auto start = std::chrono::steady_clock::now();
+            std::thread agent([header]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                header->replies.head.fetch_add(1, std::memory_order_release);
+            });
+            const bool replied = channel.waitForReply(1000);
+            const auto waited = std::chrono::steady_clock::now() - start;
+            agent.join();
+
+            THEN("It arrives within the longest sleep interval of the backoff")
+            {
+                REQUIRE(replied);
+                REQUIRE(waited < std::chrono::milliseconds(50 + 20)); // 1 ms at most, plus scheduling slack
+            }
+        }
+        munmap(mapping, sizeof(ShmChannel::Header));
+    }
+}
@@ -0,0 +1,211 @@
+//
+// Copyright (C) 2020 Dominik S. Buse <buse@ccs-labs.org>, Max Schettler <schettler@ccs-labs.org>
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "serpentine/TrajectoryRecorder.h"
+#include "testutils/Simulation.h"
+
+using omnetpp::cNullEnvir;
+
+namespace {
+
+const std::string fileName = "trajectory-recorder-test.bin";
+
+// one row as passed to TrajectoryRecorder::record()
+struct Row {
+    double time;
+    std::vector<double> observation;
+    int32_t action;
+    double reward;
+    bool done;
+    std::string leader;
+    std::string follower;
+};
+
+// decodes a trajectory file the way an offline reader would, checking the layout on the way
+class TrajectoryFile {
+public:
+    TrajectoryFile()
+    {
+        std::ifstream stream(fileName, std::ios::binary);
+        const std::vector<char> bytes{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+        REQUIRE(bytes.size() >= sizeof(header));
+        std::memcpy(&header, bytes.data(), sizeof(header));
+
+        size_t offset = sizeof(header);
+        while (offset < bytes.size()) {
+            REQUIRE(offset % 8 == 0);
+            TrajectoryRecorder::ChunkHeader chunk;
+            REQUIRE(bytes.size() - offset >= sizeof(chunk));
+            std::memcpy(&chunk, bytes.data() + offset, sizeof(chunk));
+            REQUIRE(chunk.magic == TrajectoryRecorder::chunkMagic);
+            REQUIRE(chunk.bytes % 8 == 0);
+            offset += sizeof(chunk);
+            REQUIRE(bytes.size() - offset >= chunk.bytes);
+            chunkRows.push_back(chunk.rows);
+            decodeChunk(bytes.data() + offset, chunk);
+            offset += chunk.bytes;
+        }
+    }
+
+    TrajectoryRecorder::FileHeader header;
+    std::vector<uint32_t> chunkRows;
+    std::vector<Row> rows;
+
+private:
+    template <typename T>
+    static T read(const char* column, size_t index)
+    {
+        T value;
+        std::memcpy(&value, column + index * sizeof(T), sizeof(T));
+        return value;
+    }
+
+    // ids fill their field completely or are terminated by zero padding
+    static std::string readId(const char* field, size_t idSize)
+    {
+        const char* end = std::find(field, field + idSize, '\0');
+        REQUIRE(std::all_of(end, field + idSize, [](char c) { return c == '\0'; }));
+        return std::string(field, end);
+    }
+
+    void decodeChunk(const char* data, const TrajectoryRecorder::ChunkHeader& chunk)
+    {
+        const size_t n = chunk.rows;
+        const size_t idSize = header.idSize;
+        const char* times = data;
+        const char* observations = times + n * sizeof(double);
+        const char* rewards = observations + n * header.observationSize * sizeof(double);
+        const char* actions = rewards + n * sizeof(double);
+        const char* leaders = actions + n * sizeof(int32_t);
+        const char* followers = leaders + n * idSize;
+        const char* dones = followers + n * idSize;
+        const char* padding = dones + n * sizeof(uint8_t);
+        REQUIRE(static_cast<size_t>(data + chunk.bytes - padding) < 8);
+        for (const char* p = padding; p < data + chunk.bytes; ++p) {
+            REQUIRE(*p == 0);
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            Row row;
+            row.time = read<double>(times, i);
+            for (size_t j = 0; j < header.observationSize; ++j) {
+                row.observation.push_back(read<double>(observations, i * header.observationSize + j));
+            }
+            row.reward = read<double>(rewards, i);
+            row.action = read<int32_t>(actions, i);
+            row.leader = readId(leaders + i * idSize, idSize);
+            row.follower = readId(followers + i * idSize, idSize);
+            REQUIRE(read<uint8_t>(dones, i) <= 1);
+            row.done = read<uint8_t>(dones, i);
+            rows.push_back(row);
+        }
+    }
+};
+
+void record(TrajectoryRecorder& recorder, const Row& row)
+{
+    recorder.record(row.time, row.observation.data(), row.action, row.reward, row.done, row.leader, row.follower);
+}
+
+void requireEqual(const Row& actual, const Row& expected)
+{
+    REQUIRE(actual.time == expected.time);
+    REQUIRE(actual.observation == expected.observation);
+    REQUIRE(actual.action == expected.action);
+    REQUIRE(actual.reward == expected.reward);
+    REQUIRE(actual.done == expected.done);
+    REQUIRE(actual.leader == expected.leader.substr(0, TrajectoryRecorder::idSize));
+    REQUIRE(actual.follower == expected.follower.substr(0, TrajectoryRecorder::idSize));
+}
+
+} // namespace
+
+SCENARIO("Trajectory files can be read back as written", "[trajectoryRecorder]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr));
+    std::remove(fileName.c_str());
+
+    const std::vector<Row> rows = {
+        {0.5, {0.25, -1}, 3, 0, false, "leader", "follower"},
+        {1.5, {0.5, -0.5}, 1, 0.75, false, "leader", "follower.with.a.long.id"},
+        {2.5, {1, 0}, -1, -2, true, "leader", "follower"},
+    };
+
+    GIVEN("A recorder of two observation values that writes chunks of two rows")
+    {
+        {
+            TrajectoryRecorder recorder(fileName, 2, 2);
+            for (const auto& row : rows) {
+                record(recorder, row);
+            }
+        }
+
+        THEN("The file holds a header and chunks of two and of the one remaining row, all decoding to the recorded rows")
+        {
+            TrajectoryFile file;
+            REQUIRE(file.header.magic == TrajectoryRecorder::magic);
+            REQUIRE(file.header.version == TrajectoryRecorder::version);
+            REQUIRE(file.header.observationSize == 2);
+            REQUIRE(file.header.idSize == TrajectoryRecorder::idSize);
+            REQUIRE(file.chunkRows == std::vector<uint32_t>{2, 1});
+            REQUIRE(file.rows.size() == rows.size());
+            for (size_t i = 0; i < rows.size(); ++i) {
+                requireEqual(file.rows[i], rows[i]);
+            }
+        }
+
+        WHEN("Another recorder of the same layout opens the file")
+        {
+            {
+                TrajectoryRecorder recorder(fileName, 2, 2);
+                record(recorder, rows[0]);
+            }
+
+            THEN("It appends a chunk and keeps the single header")
+            {
+                TrajectoryFile file;
+                REQUIRE(file.chunkRows == std::vector<uint32_t>{2, 1, 1});
+                REQUIRE(file.rows.size() == rows.size() + 1);
+                requireEqual(file.rows.back(), rows[0]);
+            }
+        }
+
+        WHEN("A recorder of another observation size opens the file")
+        {
+            THEN("It refuses to append to it")
+            {
+                REQUIRE_THROWS(TrajectoryRecorder(fileName, 3, 2));
+            }
+        }
+    }
+
+    std::remove(fileName.c_str());
+}